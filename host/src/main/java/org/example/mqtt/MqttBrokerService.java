@@ -35,7 +35,11 @@ public class MqttBrokerService {
     private static final String PROP_WS_PORT = "websocket_port";
     private static final String PROP_WS_PATH = "websocket_path";
     private static final String PROP_PERSISTENT_CLIENT_EXPIRATION = "persistent_client_expiration";
+    private static final String PROP_TOPIC_ALIAS_MAXIMUM = "topic_alias_maximum";
     private static final String DEFAULT_EXPIRATION_SECONDS = Integer.MAX_VALUE + "s";
+    // Covers the robot's alias table (CONFIG_APP_MQTT_TOPIC_ALIASES, default 8) with
+    // headroom; the robot uses the smaller of this and its own setting
+    private static final int TOPIC_ALIAS_MAXIMUM = 16;
 
     public enum BrokerChange {
         STARTED,
@@ -48,11 +52,23 @@ public class MqttBrokerService {
 
     public record BrokerStatus(BrokerChange change, RuntimeInfo runtimeInfo) { }
 
+    private final Path dataDir;
     private Server server;
     private boolean running;
     private RuntimeInfo runtimeInfo;
     private MqttSettings cachedSettings;
 
+    public MqttBrokerService() {
+        this(null);
+    }
+
+    /**
+     * @param dataDir broker persistence folder, or null for ~/.schachroboter/mqtt
+     */
+    MqttBrokerService(Path dataDir) {
+        this.dataDir = dataDir;
+    }
+
     public synchronized BrokerStatus applySettings(MqttSettings settings) {
         logger.debug("Applying MQTT broker settings");
         if (settings == null || !settings.isBrokerEnabled()) {
@@ -129,6 +145,7 @@ public class MqttBrokerService {
         props.setProperty(PROP_DATA_PATH, normalizedDataPath);
         props.setProperty(PROP_PERSISTENCE_ENABLED, Boolean.TRUE.toString());
         props.setProperty(PROP_PERSISTENT_CLIENT_EXPIRATION, DEFAULT_EXPIRATION_SECONDS);
+        props.setProperty(PROP_TOPIC_ALIAS_MAXIMUM, String.valueOf(TOPIC_ALIAS_MAXIMUM));
 
         if (settings.isWebsocketEnabled()) {
             props.setProperty(PROP_WS_ENABLED, Boolean.TRUE.toString());
@@ -182,6 +199,9 @@ public class MqttBrokerService {
     }
 
     private Path resolveBrokerDataPath() {
+        if (dataDir != null) {
+            return dataDir;
+        }
         return Paths.get(System.getProperty("user.home"), ".schachroboter", "mqtt");
     }
 
@@ -0,0 +1,380 @@
+package org.example.mqtt;
+
+import com.google.gson.JsonObject;
+import com.google.gson.JsonParser;
+import org.eclipse.paho.mqttv5.client.IMqttToken;
+import org.eclipse.paho.mqttv5.client.MqttCallback;
+import org.eclipse.paho.mqttv5.client.MqttClient;
+import org.eclipse.paho.mqttv5.client.MqttConnectionOptions;
+import org.eclipse.paho.mqttv5.client.MqttDisconnectResponse;
+import org.eclipse.paho.mqttv5.client.persist.MemoryPersistence;
+import org.eclipse.paho.mqttv5.common.MqttException;
+import org.eclipse.paho.mqttv5.common.MqttMessage;
+import org.eclipse.paho.mqttv5.common.packet.MqttProperties;
+import org.eclipse.paho.mqttv5.common.packet.UserProperty;
+import org.example.settings.MqttSettings;
+import org.junit.jupiter.api.AfterEach;
+import org.junit.jupiter.api.BeforeEach;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.io.TempDir;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.net.URI;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.BlockingQueue;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.TimeUnit;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+/**
+ * Runs the embedded broker the way the robot uses it with CONFIG_APP_MQTT_V5:
+ * topic aliases on repeated publishes, a correlation-id user property on
+ * results, and 3.1.1 clients on the same broker that pair replies by the id in
+ * the body.
+ */
+class MqttBrokerServiceMqtt5Test {
+
+    private static final String STATUS_TOPIC = "chess/robot/status";
+    private static final String PING_TOPIC = "chess/system/ping";
+    private static final String PONG_TOPIC = "chess/system/pong";
+    private static final long RECEIVE_TIMEOUT_S = 5;
+
+    private record Received(String topic, MqttMessage message) { }
+
+    @TempDir
+    Path tempDir;
+
+    private MqttBrokerService service;
+    private String serverUri;
+    private final List<MqttClient> clients = new ArrayList<>();
+
+    @BeforeEach
+    void startBroker() throws IOException {
+        int port;
+        try (ServerSocket socket = new ServerSocket(0)) {
+            port = socket.getLocalPort();
+        }
+
+        MqttSettings settings = new MqttSettings();
+        settings.setBrokerEnabled(true);
+        settings.setHost("127.0.0.1");
+        settings.setPort(port);
+        settings.setWebsocketEnabled(false);
+
+        service = new MqttBrokerService(tempDir);
+        service.applySettings(settings);
+        serverUri = "tcp://127.0.0.1:" + port;
+    }
+
+    @AfterEach
+    void stopBroker() {
+        for (MqttClient client : clients) {
+            try {
+                if (client.isConnected()) {
+                    client.disconnect();
+                }
+                client.close();
+            } catch (MqttException ignored) {
+                // the broker goes down next anyway
+            }
+        }
+        service.shutdown();
+    }
+
+    @Test
+    void grantsTopicAliasesAndDeliversAliasedPublishesUnderTheFullTopic() throws Exception {
+        BlockingQueue<Received> received = subscribeV5("host", STATUS_TOPIC);
+
+        // Paho hides whether it aliases, so publish the way the robot does on the wire
+        try (RawMqtt5Client robot = new RawMqtt5Client(serverUri, "robot")) {
+            int aliasMaximum = robot.connect();
+            assertTrue(aliasMaximum > 0, "CONNACK grants no topic aliases");
+
+            robot.publishWithAlias(STATUS_TOPIC, 1, "{\"seq\":0}");
+            robot.publishWithAlias("", 1, "{\"seq\":1}");
+            robot.publishWithAlias("", 1, "{\"seq\":2}");
+
+            for (int i = 0; i < 3; i++) {
+                Received msg = received.poll(RECEIVE_TIMEOUT_S, TimeUnit.SECONDS);
+                assertNotNull(msg, "publish " + i + " not delivered");
+                assertEquals(STATUS_TOPIC, msg.topic());
+                assertEquals("{\"seq\":" + i + "}", new String(msg.message().getPayload(), StandardCharsets.UTF_8));
+            }
+        }
+    }
+
+    @Test
+    void forwardsCorrelationIdUserProperty() throws Exception {
+        BlockingQueue<Received> received = subscribeV5("host", STATUS_TOPIC);
+        MqttClient robot = connectV5("robot");
+
+        MqttMessage result = message("{\"type\":\"action_complete\",\"status\":\"ok\"}");
+        MqttProperties properties = new MqttProperties();
+        properties.setUserProperties(List.of(new UserProperty("correlation-id", "42")));
+        result.setProperties(properties);
+        robot.publish(STATUS_TOPIC, result);
+
+        Received msg = received.poll(RECEIVE_TIMEOUT_S, TimeUnit.SECONDS);
+        assertNotNull(msg);
+        List<UserProperty> userProperties = msg.message().getProperties().getUserProperties();
+        assertTrue(userProperties.stream()
+                        .anyMatch(p -> p.getKey().equals("correlation-id") && p.getValue().equals("42")),
+                "correlation-id missing: " + userProperties);
+    }
+
+    @Test
+    void mqtt311ClientsShareTheBrokerWithMqtt5Clients() throws Exception {
+        BlockingQueue<String> received = new LinkedBlockingQueue<>();
+        org.eclipse.paho.client.mqttv3.MqttClient host =
+                new org.eclipse.paho.client.mqttv3.MqttClient(serverUri, "host-v3",
+                        new org.eclipse.paho.client.mqttv3.persist.MemoryPersistence());
+        host.connect();
+        host.subscribe(STATUS_TOPIC, 1, (topic, message) ->
+                received.add(topic + " " + new String(message.getPayload(), StandardCharsets.UTF_8)));
+
+        try {
+            MqttClient robot = connectV5("robot");
+            MqttMessage result = message("{\"status\":\"ok\"}");
+            MqttProperties properties = new MqttProperties();
+            properties.setUserProperties(List.of(new UserProperty("correlation-id", "7")));
+            result.setProperties(properties);
+
+            robot.publish(STATUS_TOPIC, result);
+            robot.publish(STATUS_TOPIC, result);
+
+            assertEquals(STATUS_TOPIC + " {\"status\":\"ok\"}", received.poll(RECEIVE_TIMEOUT_S, TimeUnit.SECONDS));
+            assertEquals(STATUS_TOPIC + " {\"status\":\"ok\"}", received.poll(RECEIVE_TIMEOUT_S, TimeUnit.SECONDS));
+        } finally {
+            host.disconnect();
+            host.close();
+        }
+    }
+
+    @Test
+    void mqtt311ClientPairsPongsWithPingsByTheBodySeq() throws Exception {
+        BlockingQueue<String> pongs = new LinkedBlockingQueue<>();
+        org.eclipse.paho.client.mqttv3.MqttClient host =
+                new org.eclipse.paho.client.mqttv3.MqttClient(serverUri, "host-v3",
+                        new org.eclipse.paho.client.mqttv3.persist.MemoryPersistence());
+        host.connect();
+        host.subscribe(PONG_TOPIC, 1, (topic, message) ->
+                pongs.add(new String(message.getPayload(), StandardCharsets.UTF_8)));
+
+        try {
+            // Stands in for the robot: a 3.1.1 ping carries no correlation-id, so the
+            // seq from the body is echoed in the body next to the user property
+            MqttClient robot = connectV5("robot");
+            BlockingQueue<Received> pings = subscribeV5(robot, PING_TOPIC);
+
+            org.eclipse.paho.client.mqttv3.MqttMessage ping =
+                    new org.eclipse.paho.client.mqttv3.MqttMessage("{\"seq\":9}".getBytes(StandardCharsets.UTF_8));
+            ping.setQos(1);
+            host.publish(PING_TOPIC, ping);
+
+            Received request = pings.poll(RECEIVE_TIMEOUT_S, TimeUnit.SECONDS);
+            assertNotNull(request, "ping not delivered");
+            List<UserProperty> requestProperties = request.message().getProperties().getUserProperties();
+            assertTrue(requestProperties == null || requestProperties.isEmpty(),
+                    "3.1.1 ping arrived with user properties: " + requestProperties);
+            int seq = JsonParser.parseString(new String(request.message().getPayload(), StandardCharsets.UTF_8))
+                    .getAsJsonObject().get("seq").getAsInt();
+
+            MqttMessage pong = message("{\"status\":\"pong\",\"seq\":" + seq + "}");
+            MqttProperties properties = new MqttProperties();
+            properties.setUserProperties(List.of(new UserProperty("correlation-id", String.valueOf(seq))));
+            pong.setProperties(properties);
+            robot.publish(PONG_TOPIC, pong);
+
+            String body = pongs.poll(RECEIVE_TIMEOUT_S, TimeUnit.SECONDS);
+            assertNotNull(body, "pong not delivered to the 3.1.1 client");
+            JsonObject reply = JsonParser.parseString(body).getAsJsonObject();
+            assertEquals("pong", reply.get("status").getAsString());
+            assertEquals(9, reply.get("seq").getAsInt());
+        } finally {
+            host.disconnect();
+            host.close();
+        }
+    }
+
+    private MqttClient createV5(String clientId) throws MqttException {
+        MqttClient client = new MqttClient(serverUri, clientId, new MemoryPersistence());
+        clients.add(client);
+        return client;
+    }
+
+    private MqttClient connectV5(String clientId) throws MqttException {
+        MqttClient client = createV5(clientId);
+        client.connect(new MqttConnectionOptions());
+        return client;
+    }
+
+    private BlockingQueue<Received> subscribeV5(String clientId, String topicFilter) throws MqttException {
+        return subscribeV5(connectV5(clientId), topicFilter);
+    }
+
+    private BlockingQueue<Received> subscribeV5(MqttClient client, String topicFilter) throws MqttException {
+        BlockingQueue<Received> received = new LinkedBlockingQueue<>();
+        client.setCallback(new MqttCallback() {
+            @Override
+            public void disconnected(MqttDisconnectResponse disconnectResponse) {
+            }
+
+            @Override
+            public void mqttErrorOccurred(MqttException exception) {
+            }
+
+            @Override
+            public void messageArrived(String topic, MqttMessage message) {
+                received.add(new Received(topic, message));
+            }
+
+            @Override
+            public void deliveryComplete(IMqttToken token) {
+            }
+
+            @Override
+            public void connectComplete(boolean reconnect, String serverURI) {
+            }
+
+            @Override
+            public void authPacketArrived(int reasonCode, MqttProperties properties) {
+            }
+        });
+        client.subscribe(topicFilter, 1);
+        return received;
+    }
+
+    private static MqttMessage message(String payload) {
+        MqttMessage message = new MqttMessage(payload.getBytes(StandardCharsets.UTF_8));
+        message.setQos(1);
+        return message;
+    }
+
+    /**
+     * Minimal MQTT 5.0 publisher that sets the Topic Alias property itself, so a
+     * publish with an empty topic really reaches the broker as an alias.
+     */
+    private static final class RawMqtt5Client implements AutoCloseable {
+        private static final int PROP_TOPIC_ALIAS_MAXIMUM = 0x22;
+        private static final int PROP_TOPIC_ALIAS = 0x23;
+
+        private final Socket socket;
+        private final DataOutputStream out;
+        private final DataInputStream in;
+        private final String clientId;
+
+        RawMqtt5Client(String serverUri, String clientId) throws IOException {
+            URI uri = URI.create(serverUri);
+            this.socket = new Socket(uri.getHost(), uri.getPort());
+            this.socket.setSoTimeout((int) TimeUnit.SECONDS.toMillis(RECEIVE_TIMEOUT_S));
+            this.out = new DataOutputStream(socket.getOutputStream());
+            this.in = new DataInputStream(socket.getInputStream());
+            this.clientId = clientId;
+        }
+
+        /** Sends CONNECT with a clean start and returns the granted Topic Alias Maximum. */
+        int connect() throws IOException {
+            ByteArrayOutputStream body = new ByteArrayOutputStream();
+            DataOutputStream packet = new DataOutputStream(body);
+            packet.writeUTF("MQTT");
+            packet.writeByte(5);
+            packet.writeByte(0x02);
+            packet.writeShort(60);
+            writeVarInt(packet, 0);
+            packet.writeUTF(clientId);
+            send(0x10, body.toByteArray());
+
+            int header = in.readUnsignedByte();
+            assertEquals(0x20, header, "expected CONNACK");
+            byte[] connack = in.readNBytes(readVarInt(in));
+            DataInputStream ack = new DataInputStream(new ByteArrayInputStream(connack));
+            ack.readUnsignedByte();
+            assertEquals(0, ack.readUnsignedByte(), "CONNECT refused");
+
+            int aliasMaximum = 0;
+            int propertiesLength = readVarInt(ack);
+            int end = connack.length - ack.available() + propertiesLength;
+            while (connack.length - ack.available() < end) {
+                int id = ack.readUnsignedByte();
+                if (id == PROP_TOPIC_ALIAS_MAXIMUM) {
+                    aliasMaximum = ack.readUnsignedShort();
+                } else {
+                    skipProperty(ack, id);
+                }
+            }
+            return aliasMaximum;
+        }
+
+        /** QoS 0 publish; an empty topic sends only the alias bound earlier. */
+        void publishWithAlias(String topic, int alias, String payload) throws IOException {
+            ByteArrayOutputStream body = new ByteArrayOutputStream();
+            DataOutputStream packet = new DataOutputStream(body);
+            packet.writeUTF(topic);
+            writeVarInt(packet, 3);
+            packet.writeByte(PROP_TOPIC_ALIAS);
+            packet.writeShort(alias);
+            packet.write(payload.getBytes(StandardCharsets.UTF_8));
+            send(0x30, body.toByteArray());
+        }
+
+        @Override
+        public void close() throws IOException {
+            try {
+                send(0xE0, new byte[0]);
+            } finally {
+                socket.close();
+            }
+        }
+
+        private void send(int header, byte[] body) throws IOException {
+            out.writeByte(header);
+            writeVarInt(out, body.length);
+            out.write(body);
+            out.flush();
+        }
+
+        private static void writeVarInt(DataOutputStream out, int value) throws IOException {
+            do {
+                int digit = value & 0x7F;
+                value >>>= 7;
+                out.writeByte(value > 0 ? digit | 0x80 : digit);
+            } while (value > 0);
+        }
+
+        private static int readVarInt(DataInputStream in) throws IOException {
+            int value = 0;
+            for (int shift = 0; ; shift += 7) {
+                int digit = in.readUnsignedByte();
+                value |= (digit & 0x7F) << shift;
+                if ((digit & 0x80) == 0) {
+                    return value;
+                }
+            }
+        }
+
+        private static void skipProperty(DataInputStream in, int id) throws IOException {
+            switch (id) {
+                case 0x01, 0x17, 0x19, 0x24, 0x25, 0x28, 0x29, 0x2A -> in.skipNBytes(1);
+                case 0x13, 0x21, 0x22, 0x23 -> in.skipNBytes(2);
+                case 0x02, 0x11, 0x18, 0x27 -> in.skipNBytes(4);
+                case 0x0B -> readVarInt(in);
+                case 0x03, 0x08, 0x09, 0x12, 0x15, 0x16, 0x1A, 0x1C, 0x1F -> in.skipNBytes(in.readUnsignedShort());
+                case 0x26 -> {
+                    in.skipNBytes(in.readUnsignedShort());
+                    in.skipNBytes(in.readUnsignedShort());
+                }
+                default -> fail("unknown CONNACK property 0x" + Integer.toHexString(id));
+            }
+        }
+    }
+}
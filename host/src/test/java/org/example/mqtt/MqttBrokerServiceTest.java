@@ -31,6 +31,7 @@ class MqttBrokerServiceTest {
         assertEquals(Boolean.TRUE.toString(), props.getProperty("persistence_enabled"));
         assertEquals(tempDir.toString().replace("\\", "/"), props.getProperty("data_path"));
         assertEquals(Integer.MAX_VALUE + "s", props.getProperty("persistent_client_expiration"));
+        assertEquals("16", props.getProperty("topic_alias_maximum"));
     }
 
     @Test
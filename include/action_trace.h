@@ -0,0 +1,61 @@
+#ifndef ACTION_TRACE_H
+#define ACTION_TRACE_H
+
+#include <stdint.h>
+#include "movement_planner.h"
+
+/**
+ * Per-stage latency of planned actions.
+ *
+ * Every completed action's planner_trace_t is folded into one log2
+ * histogram per stage: bucket n counts durations of [2^n, 2^(n+1)) µs,
+ * bucket 0 also takes 0 µs and the last bucket everything longer.
+ */
+
+#define ACTION_TRACE_BUCKETS 28 /* up to ~134 s */
+
+typedef enum {
+    ACTION_STAGE_INGRESS,   /**< received -> parsed (MQTT queue and JSON decode) */
+    ACTION_STAGE_SUBMIT,    /**< parsed -> enqueued                             */
+    ACTION_STAGE_QUEUE,     /**< enqueued -> dequeued (waiting for the robot)   */
+    ACTION_STAGE_PRIMITIVE, /**< each pickup/place, start to next or completion */
+    ACTION_STAGE_EXECUTE,   /**< dequeued -> completed                          */
+    ACTION_STAGE_TOTAL,     /**< received -> completed                          */
+    ACTION_STAGE_COUNT,
+} action_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[ACTION_TRACE_BUCKETS];
+} action_latency_t;
+
+/**
+ * @brief Time base of planner_trace_t, in microseconds since boot.
+ */
+int64_t action_trace_now_us(void);
+
+/**
+ * @brief Record that @p trace reached a stage now; returns the offset stored.
+ */
+uint32_t action_trace_mark(const planner_trace_t *trace);
+
+/**
+ * @brief Add a completed action's trace to the histograms.
+ */
+void action_trace_record(const planner_trace_t *trace);
+
+/**
+ * @brief Copy the histogram of @p stage.
+ */
+void action_trace_get(action_stage_t stage, action_latency_t *out);
+
+/**
+ * @brief Clear all histograms.
+ */
+void action_trace_reset(void);
+
+const char *action_stage_name(action_stage_t stage);
+
+#endif /* ACTION_TRACE_H */
@@ -0,0 +1,61 @@
+#ifndef BOARD_HISTORY_H
+#define BOARD_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Number of frames kept; must be a power of two */
+#define BOARD_HISTORY_SIZE 128
+
+typedef enum {
+    BOARD_FRAME_RAW       = 0, /**< Scan result that differed from the previous scan */
+    BOARD_FRAME_DEBOUNCED = 1, /**< Frame accepted by the debouncer */
+} board_frame_kind_t;
+
+/**
+ * One recorded change of the sensor matrix.
+ *
+ * @c cycles is the hardware cycle counter extended to 64 bits, so frames
+ * can be ordered and spaced with sub-microsecond resolution.
+ */
+typedef struct {
+    uint64_t cycles;
+    uint64_t mask;
+    uint32_t seq;  /**< Running record number, starts at 0 */
+    uint8_t kind;  /**< board_frame_kind_t */
+} board_frame_t;
+
+/**
+ * @brief Append a frame to the ring, overwriting the oldest one when full.
+ *
+ * Single producer: must only be called from the board scanning thread.
+ * Readers on other threads never block it.
+ */
+void board_history_record(board_frame_kind_t kind, uint64_t mask);
+
+/**
+ * @brief Sequence number the next recorded frame will get.
+ */
+uint32_t board_history_head(void);
+
+/**
+ * @brief Oldest sequence number that may still be in the ring.
+ */
+uint32_t board_history_oldest(void);
+
+/**
+ * @brief Copy frame @p seq out of the ring.
+ *
+ * @return 0 on success, -ENOENT if the frame was not recorded yet or has
+ *         been overwritten (also while the copy was in progress).
+ */
+int board_history_read(uint32_t seq, board_frame_t *frame);
+
+/**
+ * @brief Current time on the history clock.
+ */
+uint64_t board_history_now_cycles(void);
+
+uint64_t board_history_cycles_to_us(uint64_t cycles);
+
+#endif
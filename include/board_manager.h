@@ -1,15 +1,169 @@
 #ifndef BOARD_MANAGER_H
 #define BOARD_MANAGER_H
 
+#include <zephyr/kernel.h>
 #include "board_state.h"
+#include "board_history.h"
+#include "movement_planner.h"
+
+/**
+ * Consolidated result of a robot action, checked against the sensor matrix.
+ *
+ * While the planner runs, changes on the squares it touches are withheld
+ * from the move/state callbacks. Once the action ends, the next scan is
+ * compared against the occupancy the action should have produced.
+ */
+typedef struct
+{
+    planner_action_t action;
+    planner_result_t result;
+    uint64_t squares;       /* matrix bits touched by the action */
+    uint64_t expected_mask; /* expected occupancy of those squares */
+    uint64_t observed_mask; /* scanned occupancy of those squares */
+    bool verified;          /* planner succeeded and observed == expected */
+    uint32_t timestamp;
+} board_robot_move_t;
+
+/* Limits board_manager_set_scan_config() enforces */
+#define BOARD_SCAN_INTERVAL_MIN_MS 5
+#define BOARD_SCAN_INTERVAL_MAX_MS 5000
+#define BOARD_SCAN_DECAY_MAX_MS    60000
+
+/**
+ * Activity-driven scan scheduling.
+ *
+ * The board is scanned every @c idle_interval_ms while nothing happens and
+ * every @c active_interval_ms from the first raw change, while a robot
+ * action is in flight or when the human's turn starts. Without further
+ * activity the rate falls back to idle after @c decay_ms, also during the
+ * human's turn. Any committed human move, capture or castling ends the turn.
+ */
+typedef struct
+{
+    uint32_t idle_interval_ms;
+    uint32_t active_interval_ms;
+    uint32_t decay_ms;
+} board_scan_config_t;
+
+/**
+ * Replay of recorded frames through the move detector.
+ *
+ * Frames of kind @c source recorded in [@c from_us, @c to_us] are fed in
+ * order through the same inference path as live scans, starting from the
+ * last frame of that kind before the window. Live board state is not
+ * touched. Moves are passed to the move callback with
+ * BOARD_MOVE_FLAG_REPLAY set only if @c report_moves is true, which also
+ * keeps publishing cost out of the timings.
+ */
+typedef struct
+{
+    uint64_t from_us;
+    uint64_t to_us;
+    board_frame_kind_t source;
+    bool report_moves;
+} board_replay_request_t;
+
+typedef struct
+{
+    board_replay_request_t request;
+    uint32_t frames;        /* frames fed through the detector */
+    uint32_t moves;         /* single moves inferred */
+    uint32_t missing;       /* frames overwritten while replaying */
+    uint32_t min_cycles;    /* per-frame inference cost */
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} board_replay_result_t;
+
+/**
+ * Per-square reed switch health, derived from every raw scan.
+ *
+ * A square whose transition count within one flap window reaches the
+ * threshold is masked: its last trusted value is frozen so it cannot
+ * produce spurious moves. It is unmasked again after a number of quiet
+ * windows.
+ */
+typedef struct
+{
+    uint64_t masked;                              /* squares currently ignored */
+    uint64_t flapping;                            /* squares over the threshold in the current window */
+    uint16_t transitions[CHESS_BOARD_SIZE * CHESS_BOARD_SIZE];    /* lifetime raw transitions (saturating) */
+    uint8_t window_transitions[CHESS_BOARD_SIZE * CHESS_BOARD_SIZE];
+    uint32_t stuck_ms[CHESS_BOARD_SIZE * CHESS_BOARD_SIZE];       /* time since the square last changed */
+    uint32_t frames;                              /* raw scans accounted */
+    uint32_t window_ms;
+    uint32_t timestamp;
+} board_health_t;
 
 typedef void (*board_move_callback_t)(const board_move_t *move);
 typedef void (*board_state_callback_t)(const chess_board_state_t *state);
+typedef void (*board_robot_move_callback_t)(const board_robot_move_t *robot_move);
+typedef void (*board_replay_callback_t)(const board_replay_result_t *result);
+typedef void (*board_health_callback_t)(const board_health_t *health);
 
 int board_manager_init(void);
 int board_manager_update(void);
 const chess_board_state_t *board_manager_get_state(void);
+
+/**
+ * @brief Wait for a debounced frame from a scan that starts after this call.
+ *
+ * Unlike board_manager_get_state(), the returned mask is the raw debounced
+ * occupancy, including squares currently gated for a robot action.
+ *
+ * @param mask     Receives the occupancy mask.
+ * @param timeout  Maximum time to wait.
+ * @return 0 on success, -ETIMEDOUT if no stable frame arrived in time.
+ */
+int board_manager_wait_fresh_scan(uint64_t *mask, k_timeout_t timeout);
+
+/**
+ * @brief Sleep until the next scan is due, returning early when a fresh
+ *        scan is requested or the schedule changes.
+ */
+void board_manager_wait_next_scan(void);
+
+/**
+ * @brief Current delay between the end of one scan and the start of the next.
+ */
+uint32_t board_manager_get_scan_interval_ms(void);
+
+void board_manager_get_scan_config(board_scan_config_t *config);
+
+/**
+ * @brief Replace the scan schedule; takes effect before the next scan.
+ * @return 0 on success, -EINVAL if an interval is outside
+ *         [BOARD_SCAN_INTERVAL_MIN_MS, BOARD_SCAN_INTERVAL_MAX_MS], active > idle
+ *         or decay exceeds BOARD_SCAN_DECAY_MAX_MS.
+ */
+int board_manager_set_scan_config(const board_scan_config_t *config);
+
+/**
+ * @brief Mark whether the human is expected to move.
+ *
+ * Set automatically when robot actions settle and cleared when a human
+ * move, capture or castling is detected; the host may override it at any
+ * time. Setting it scans at the active rate for the next decay_ms.
+ */
+void board_manager_set_human_turn(bool human_turn);
+bool board_manager_is_human_turn(void);
+/**
+ * @brief Queue a history replay; it runs on the scanning thread before the next scan.
+ * @return 0 on success, -EINVAL on a bad window, -EBUSY if a replay is already pending.
+ */
+int board_manager_request_replay(const board_replay_request_t *request);
+
+/**
+ * @brief Snapshot the sensor health counters.
+ *
+ * Must be called from the scanning thread (e.g. a registered callback);
+ * other threads receive the periodic report through the health callback.
+ */
+void board_manager_get_health(board_health_t *health);
+
 void board_manager_register_move_callback(board_move_callback_t callback);
 void board_manager_register_state_callback(board_state_callback_t callback);
+void board_manager_register_robot_move_callback(board_robot_move_callback_t callback);
+void board_manager_register_replay_callback(board_replay_callback_t callback);
+void board_manager_register_health_callback(board_health_callback_t callback);
 
 #endif
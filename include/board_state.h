@@ -18,11 +18,16 @@ typedef struct
     uint8_t col;
 } board_position_t;
 
+/* Move was inferred from recorded frames during a history replay */
+#define BOARD_MOVE_FLAG_REPLAY (1U << 0)
+
 typedef struct
 {
     board_position_t from;
     board_position_t to;
     uint32_t timestamp;
+    uint64_t timestamp_us; /* time of the frame that completed the move */
+    uint8_t flags;
 } board_move_t;
 
 typedef struct
@@ -33,6 +38,24 @@ typedef struct
     uint32_t move_count;
 } chess_board_state_t;
 
+/*
+ * Chess square to matrix bit mapping.
+ * Matrix row 0 holds rank 8 and column 0 holds file a (host view, white at the bottom).
+ */
+static inline uint8_t square_index(uint8_t file, uint8_t rank)
+{
+    return (CHESS_BOARD_SIZE - 1 - rank) * CHESS_BOARD_SIZE + file;
+}
+
+static inline uint64_t square_bit(uint8_t file, uint8_t rank)
+{
+    if (file >= CHESS_BOARD_SIZE || rank >= CHESS_BOARD_SIZE)
+    {
+        return 0;
+    }
+    return 1ULL << square_index(file, rank);
+}
+
 static inline bool is_square_occupied(uint64_t mask, uint8_t row, uint8_t col)
 {
     if (row >= CHESS_BOARD_SIZE || col >= CHESS_BOARD_SIZE)
@@ -4,7 +4,8 @@
 /**
  * @brief Initialize diagnostics MQTT handlers
  * 
- * Subscribes to diagnostic topics for manual motor control and testing:
+ * Subscribes to each diagnostic topic exactly, so the responses below are
+ * not sent back to the device, for manual motor control and testing:
  *   chess/diag/stepper/move   - Move a specific stepper motor
  *   chess/diag/stepper/stop   - Stop a specific or all stepper motors
  *   chess/diag/stepper/status - Query stepper motor status
@@ -12,10 +13,17 @@
  *   chess/diag/stepper/home   - Set current position as home (zero)
  *   chess/diag/servo/set      - Set servo angle
  *   chess/diag/servo/enable   - Enable/disable servo
+ *   chess/diag/latency/status - Per-stage action latency histograms
+ *   chess/diag/latency/reset  - Clear the latency histograms
+ *   chess/diag/json/arena     - cJSON arena high-water marks
+ *   chess/diag/system/resources - Stack, heap, net pool and queue usage
  * 
  * Responses are published to:
  *   chess/diag/stepper/response
  *   chess/diag/servo/response
+ *   chess/diag/latency/response
+ *   chess/diag/json/response
+ *   chess/diag/system/response
  * 
  * @return 0 on success, negative errno on failure
  */
@@ -0,0 +1,76 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * Bump-pointer arenas behind cJSON's allocation hooks.
+ *
+ * A thread that attaches an arena gets all of its cJSON allocations from
+ * the arena. cJSON_Delete() frees nothing there; the thread resets the
+ * whole arena in O(1) once a message is handled, so the shared heap is
+ * never fragmented by the many small nodes of a parse. Threads without an
+ * arena, and allocations that do not fit, fall back to k_malloc().
+ *
+ * Nothing cJSON allocated may be kept across json_arena_reset().
+ */
+
+#define JSON_ARENA_MAX   2
+#define JSON_ARENA_ALIGN 8
+
+typedef struct {
+    const char *name;
+    uint8_t *buf;
+    size_t size;
+    size_t used;
+    k_tid_t owner;
+    size_t high_water;  /**< most bytes in use between two resets */
+    uint32_t fallbacks; /**< allocations that did not fit and went to the heap */
+    uint32_t resets;
+} json_arena_t;
+
+/**
+ * @brief Define a static arena of @p _size bytes.
+ */
+#define JSON_ARENA_DEFINE(_name, _size)                                    \
+    static uint8_t __aligned(JSON_ARENA_ALIGN) _name##_buf[_size];         \
+    static json_arena_t _name = {                                          \
+        .name = #_name,                                                    \
+        .buf = _name##_buf,                                                \
+        .size = (_size),                                                   \
+    }
+
+/**
+ * @brief Route cJSON's allocations through the arenas. Call once at boot,
+ *        before any cJSON use.
+ */
+void json_arena_init(void);
+
+/**
+ * @brief Give the calling thread @p arena for its cJSON allocations.
+ *
+ * @return 0, or -ENOMEM if JSON_ARENA_MAX arenas are attached already
+ */
+int json_arena_attach(json_arena_t *arena);
+
+/**
+ * @brief Release everything allocated from @p arena. Owner thread only.
+ */
+void json_arena_reset(json_arena_t *arena);
+
+/**
+ * @brief Number of attached arenas, for json_arena_get().
+ */
+int json_arena_count(void);
+
+/**
+ * @brief Copy of attached arena @p index, statistics included.
+ *
+ * @return 0, or -ENOENT if there is no such arena
+ */
+int json_arena_get(int index, json_arena_t *out);
+
+#endif /* JSON_ARENA_H */
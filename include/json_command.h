@@ -0,0 +1,54 @@
+#ifndef JSON_COMMAND_H
+#define JSON_COMMAND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/data/json.h>
+
+/**
+ * Schema-driven decoding of small command payloads with Zephyr's JSON
+ * library.
+ *
+ * The payload is copied into a caller-provided scratch buffer (usually on
+ * the stack) because json_obj_parse() tokenizes in place; string fields in
+ * the decoded struct point into that buffer and stay valid as long as it
+ * does. Nothing is allocated, unknown fields are skipped.
+ *
+ * @code
+ * struct servo_request req = {0};
+ * char scratch[JSON_COMMAND_MAX];
+ * int64_t fields = json_command_parse(payload, payload_len, scratch, sizeof(scratch),
+ *                                     servo_descr, ARRAY_SIZE(servo_descr), &req);
+ * const char *missing = json_command_missing(servo_descr, ARRAY_SIZE(servo_descr),
+ *                                            fields, BIT(0));
+ * @endcode
+ */
+
+/* Largest command payload accepted, including the terminator */
+#define JSON_COMMAND_MAX 256
+
+/**
+ * @brief Decode @p payload into @p obj according to @p descr.
+ *
+ * @return Bitmask of the decoded fields (bit n = descr[n]), -EMSGSIZE if the
+ *         payload does not fit in @p scratch, or -EINVAL if it is not a JSON
+ *         object or a field has the wrong type.
+ */
+int64_t json_command_parse(const uint8_t *payload, uint32_t payload_len,
+                           char *scratch, size_t scratch_size,
+                           const struct json_obj_descr *descr, size_t descr_len,
+                           void *obj);
+
+/**
+ * @brief Name of the first field in @p required that was not decoded.
+ * @return Field name, or NULL if all required fields are present.
+ */
+const char *json_command_missing(const struct json_obj_descr *descr, size_t descr_len,
+                                 int64_t decoded, uint32_t required);
+
+/**
+ * @brief Describe a json_command_parse() result for error responses.
+ */
+const char *json_command_strerror(int64_t result);
+
+#endif
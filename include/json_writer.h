@@ -0,0 +1,111 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Streaming JSON encoder into a caller-provided buffer.
+ *
+ * Produces compact JSON (no whitespace) without touching the heap. Commas
+ * are inserted automatically; inside an object every value must be
+ * preceded by jw_key() (or use the jw_field_* shorthands). Once the buffer
+ * is full further output is dropped and jw_finish() reports the overflow,
+ * so callers only need to check the result once.
+ *
+ * @code
+ * char buf[128];
+ * json_writer_t w;
+ * jw_init(&w, buf, sizeof(buf));
+ * jw_object_begin(&w);
+ * jw_field_string(&w, "status", "ok");
+ * jw_field_uint(&w, "timestamp", k_uptime_get_32());
+ * jw_object_end(&w);
+ * int len = jw_finish(&w);
+ * @endcode
+ */
+
+/* Maximum nesting depth of objects and arrays */
+#define JW_MAX_DEPTH 16
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    uint8_t depth;
+    bool after_key;
+    bool overflow;
+    uint32_t has_items; /* bit n: container at depth n already holds an item */
+} json_writer_t;
+
+void jw_init(json_writer_t *w, char *buf, size_t size);
+
+/**
+ * @brief NUL-terminate the output.
+ * @return Length of the JSON text, or -ENOMEM if it did not fit or
+ *         containers were left open.
+ */
+int jw_finish(json_writer_t *w);
+
+void jw_object_begin(json_writer_t *w);
+void jw_object_end(json_writer_t *w);
+void jw_array_begin(json_writer_t *w);
+void jw_array_end(json_writer_t *w);
+
+/** @brief Emit an object key; the next call must write its value. */
+void jw_key(json_writer_t *w, const char *key);
+
+void jw_string(json_writer_t *w, const char *value);
+void jw_int(json_writer_t *w, int64_t value);
+void jw_uint(json_writer_t *w, uint64_t value);
+void jw_bool(json_writer_t *w, bool value);
+void jw_null(json_writer_t *w);
+
+/** @brief Bitmask as a "0x%016llx" string, the format used for board masks. */
+void jw_hex64(json_writer_t *w, uint64_t value);
+
+/* Key/value shorthands for object members */
+static inline void jw_field_string(json_writer_t *w, const char *key, const char *value)
+{
+    jw_key(w, key);
+    jw_string(w, value);
+}
+
+static inline void jw_field_int(json_writer_t *w, const char *key, int64_t value)
+{
+    jw_key(w, key);
+    jw_int(w, value);
+}
+
+static inline void jw_field_uint(json_writer_t *w, const char *key, uint64_t value)
+{
+    jw_key(w, key);
+    jw_uint(w, value);
+}
+
+static inline void jw_field_bool(json_writer_t *w, const char *key, bool value)
+{
+    jw_key(w, key);
+    jw_bool(w, value);
+}
+
+static inline void jw_field_hex64(json_writer_t *w, const char *key, uint64_t value)
+{
+    jw_key(w, key);
+    jw_hex64(w, value);
+}
+
+static inline void jw_field_object_begin(json_writer_t *w, const char *key)
+{
+    jw_key(w, key);
+    jw_object_begin(w);
+}
+
+static inline void jw_field_array_begin(json_writer_t *w, const char *key)
+{
+    jw_key(w, key);
+    jw_array_begin(w);
+}
+
+#endif
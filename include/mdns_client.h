@@ -3,6 +3,44 @@
 
 #include <zephyr/net/socket.h>
 
+/*
+ * Cached _mqtt._tcp.local resolution. A background listener keeps the
+ * PTR/SRV/A chain of the first instance found and re-queries each record
+ * before its TTL runs out, so lookups are normally answered from memory.
+ */
+
+/**
+ * @brief Called on the listener thread when the broker's address or port changes.
+ */
+typedef void (*mdns_broker_change_callback_t)(const struct sockaddr_in *addr);
+
+/**
+ * @brief Start the listener thread.
+ */
+int mdns_client_start(void);
+
+/**
+ * @brief Broker address from the cache, without waiting.
+ * @return 0, or -ENOENT if no unexpired SRV and A record is cached.
+ */
+int mdns_lookup_mqtt(struct sockaddr_in *out_addr, uint16_t *out_port);
+
+/**
+ * @brief Broker address from the cache, or wait up to @p timeout_ms for the
+ *        listener to resolve it.
+ * @return 0 or -ETIMEDOUT.
+ */
 int mdns_browse_mqtt(struct sockaddr_in *out_addr, uint16_t *out_port, int timeout_ms);
 
+/**
+ * @brief Forget the cached address so the listener queries it again, e.g.
+ *        after a connect to it failed.
+ */
+void mdns_flush_mqtt(void);
+
+/**
+ * @brief Register the callback for broker moves (one callback, NULL to clear).
+ */
+void mdns_register_broker_change_callback(mdns_broker_change_callback_t callback);
+
 #endif /* MDNS_CLIENT_H */
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <zephyr/kernel.h>
 
 /**
  * A single square on the chessboard.
@@ -48,6 +49,25 @@ typedef enum {
     PLANNER_ACTION_REMOVE      = 4,
 } planner_action_type_t;
 
+/** Pickups and places timed per action; a castle or capture has four. */
+#define PLANNER_TRACE_PRIMITIVES 4
+
+/**
+ * Timestamps along an action's path, from the MQTT request to completion.
+ *
+ * @c start_us is microseconds since boot (action_trace_now_us()); every
+ * other field is microseconds after it, 0 if the stage was not reached.
+ */
+typedef struct {
+    int64_t start_us;     /**< Request read off the MQTT socket.          */
+    uint32_t parsed_us;   /**< Command decoded into an action.            */
+    uint32_t enqueued_us; /**< Accepted into the action queue.            */
+    uint32_t dequeued_us; /**< Taken by the robot thread.                 */
+    uint32_t primitive_us[PLANNER_TRACE_PRIMITIVES]; /**< Each pickup/place start. */
+    uint8_t primitives;   /**< Entries used in @c primitive_us.           */
+    uint32_t completed_us;
+} planner_trace_t;
+
 /**
  * Fully describes one chess action for the planner.
  *
@@ -71,19 +91,88 @@ typedef struct {
 
     chess_square_t from2;      /**< CASTLE: king source square.              */
     chess_square_t to2;        /**< CASTLE: king destination square.         */
+
+    uint32_t id;               /**< Host request id, echoed with the result (0 = none). */
+    uint16_t batch;            /**< Batch the action was enqueued with (0 = single).    */
+    uint8_t batch_index;       /**< Position within the batch.                          */
+    uint8_t batch_size;        /**< Number of actions in the batch.                     */
+    bool id_in_body;           /**< @c id came in the JSON body and is echoed there.    */
+    planner_trace_t trace;     /**< Filled in as the action moves through the system.   */
 } planner_action_t;
 
 typedef enum {
     PLANNER_OK          =  0,  /**< Action completed successfully.           */
     PLANNER_ERR_BUSY    = -1,  /**< Planner is already executing an action.  */
     PLANNER_ERR_INVALID = -2,  /**< Action descriptor is malformed.          */
-    PLANNER_ERR_MOTOR   = -3,  /**< A motor command returned an error.       */
+    PLANNER_ERR_MOTOR   = -3,  /**< A motor command failed or a grip missed. */
+    PLANNER_ERR_ABORTED = -4,  /**< Skipped: an earlier action of its batch failed. */
 } planner_result_t;
 
+/**
+ * Execution phases reported while an action runs.
+ *
+ * ACTION_BEGIN and ACTION_END bracket every call to
+ * movement_planner_execute(); PICKUP and PLACE are emitted at the start of
+ * each primitive so observers know which square the gripper is working on.
+ */
+typedef enum {
+    PLANNER_PHASE_IDLE         = 0,
+    PLANNER_PHASE_ACTION_BEGIN = 1,
+    PLANNER_PHASE_PICKUP       = 2,
+    PLANNER_PHASE_PLACE        = 3,
+    PLANNER_PHASE_ACTION_END   = 4,
+} planner_phase_t;
+
+typedef struct {
+    planner_phase_t phase;
+    const planner_action_t *action; /**< Action being executed (valid during the callback only). */
+    chess_square_t square;          /**< PICKUP / PLACE: square being worked on.               */
+    bool on_board;                  /**< PICKUP / PLACE: false when targeting the graveyard.   */
+    planner_result_t result;        /**< ACTION_END: outcome of the action.                    */
+} planner_phase_event_t;
+
+/**
+ * @brief Callback invoked on the robot thread at every phase transition.
+ *
+ * Must not block: the planner is driving the stepper loop.
+ */
+typedef void (*planner_phase_callback_t)(const planner_phase_event_t *event);
+
+/**
+ * @brief Source of sensor-matrix frames used to verify pickups and places.
+ *
+ * Must block until a debounced frame scanned after the call is available
+ * and store it in @p mask (bit layout of board_state.h).
+ *
+ * @return 0 on success, negative errno if no frame arrived within @p timeout.
+ */
+typedef int (*planner_occupancy_probe_t)(uint64_t *mask, k_timeout_t timeout);
+
 void movement_planner_init(void);
 
+/**
+ * @brief Register the observer notified of planner phase transitions.
+ */
+void movement_planner_register_phase_callback(planner_phase_callback_t callback);
 
-planner_result_t movement_planner_execute(const planner_action_t *action);
+/**
+ * @brief Register the sensor source used for closed-loop grip verification.
+ *
+ * Without a probe, pickups and places are executed open-loop.
+ */
+void movement_planner_register_occupancy_probe(planner_occupancy_probe_t probe);
+
+/**
+ * @brief Return the phase of the currently executing action.
+ */
+planner_phase_t movement_planner_get_phase(void);
+
+/**
+ * @brief Execute @p action, blocking until it is complete.
+ *
+ * The start of every pickup and place is recorded in @p action->trace.
+ */
+planner_result_t movement_planner_execute(planner_action_t *action);
 
 int movement_planner_parse_square(const char *str, chess_square_t *out);
 
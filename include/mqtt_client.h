@@ -5,11 +5,60 @@
 
 typedef void (*mqtt_message_callback_t)(const char *topic, const uint8_t *payload, uint32_t payload_len);
 
+/* Queue priority of a topic, for inbound callbacks and outbound publishes */
+typedef enum {
+    MQTT_PRIO_NORMAL = 0,
+    MQTT_PRIO_HIGH   = 1, /**< Handled ahead of everything queued at normal priority */
+} mqtt_priority_t;
+
 int app_mqtt_init(void);
 void mqtt_client_thread(void *p1, void *p2, void *p3);
+
+/**
+ * @brief Queue a message for the MQTT thread.
+ *
+ * QoS, retain flag, rate limit and queue priority come from the per-topic
+ * policy table in mqtt_client.c. So does whether the message is kept while
+ * the broker is unreachable (moves, action results, board state) and sent
+ * after the reconnect, or rejected with -ENOTCONN.
+ *
+ * @return 0 if queued or kept, -ENOTCONN, -EMSGSIZE, -ENOBUFS if the queue is full,
+ *         or -EAGAIN if the topic's rate limit dropped the message.
+ */
 int app_mqtt_publish(const char *topic, const char *payload, uint32_t payload_len);
+
+/**
+ * @brief Publish with the retain flag set, so the broker hands the last
+ *        message to every new subscriber (used for keyframes).
+ */
+int app_mqtt_publish_retained(const char *topic, const char *payload, uint32_t payload_len);
+
+/**
+ * @brief Like app_mqtt_publish(), for a response to a request that carried
+ *        @p correlation_id (0 = none).
+ *
+ * Over MQTT 5.0 the id is sent in a "correlation-id" user property; over
+ * 3.1.1 it is dropped. Ids that came in the request body go back in the
+ * payload as well, for clients that do not read user properties.
+ */
+int app_mqtt_publish_correlated(const char *topic, const char *payload, uint32_t payload_len,
+                                uint32_t correlation_id);
+
+/**
+ * @brief Subscribe to a topic filter ('+' and '#' wildcards allowed).
+ *
+ * Callbacks run on the MQTT ingress worker, not on the MQTT thread. The
+ * payload is only valid until the callback returns.
+ */
 int app_mqtt_subscribe(const char *topic, mqtt_message_callback_t callback);
 
+/**
+ * @brief Like app_mqtt_subscribe(), with messages on this filter handled
+ *        ahead of normal priority ones (e.g. stop before move).
+ */
+int app_mqtt_subscribe_priority(const char *topic, mqtt_message_callback_t callback,
+                                mqtt_priority_t prio);
+
 bool app_mqtt_is_connected(void);
 
 #endif
\ No newline at end of file
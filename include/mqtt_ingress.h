@@ -0,0 +1,64 @@
+#ifndef MQTT_INGRESS_H
+#define MQTT_INGRESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/net/buf.h>
+#include "mqtt_client.h"
+
+/*
+ * Inbound message queue between the MQTT thread and the subscriber
+ * callbacks. The MQTT thread only reads the payload into a pooled buffer
+ * and queues it; a dedicated worker runs the callbacks, so slow handlers
+ * (JSON parsing, motor commands) never delay socket reads or keepalives.
+ */
+
+/**
+ * @brief Start the ingress worker thread.
+ */
+int mqtt_ingress_init(void);
+
+/**
+ * @brief Allocate a buffer for an incoming payload of @p len bytes.
+ *
+ * Small high priority messages come from a reserved pool, so a stop
+ * command still gets through while the queue is full of moves.
+ *
+ * @return Buffer with room for @p len bytes plus a NUL terminator, or NULL
+ *         if the payload is too large or the queue is full.
+ */
+struct net_buf *mqtt_ingress_alloc(uint32_t len, mqtt_priority_t prio);
+
+/**
+ * @brief Queue a received message for the worker.
+ *
+ * Takes over the reference to @p buf. @p topic does not need to be
+ * NUL-terminated and is copied. @p correlation_id is handed to the callback
+ * through app_mqtt_rx_correlation_id().
+ *
+ * @return 0, or -EMSGSIZE if the topic is too long (the buffer is released).
+ */
+int mqtt_ingress_submit(struct net_buf *buf, const uint8_t *topic, size_t topic_len,
+                        mqtt_message_callback_t callback, mqtt_priority_t prio,
+                        uint32_t correlation_id);
+
+/**
+ * @brief When the message being handled was read off the socket, in
+ *        microseconds since boot (k_uptime_ticks() based, like
+ *        action_trace_now_us()). Only meaningful inside a subscriber callback.
+ */
+int64_t app_mqtt_rx_time_us(void);
+
+/**
+ * @brief Numeric "correlation-id" user property of the message being
+ *        handled, 0 if it had none (always 0 over MQTT 3.1.1). Only
+ *        meaningful inside a subscriber callback.
+ */
+uint32_t app_mqtt_rx_correlation_id(void);
+
+/**
+ * @brief Number of received messages waiting for the worker.
+ */
+uint32_t mqtt_ingress_queued(void);
+
+#endif
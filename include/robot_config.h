@@ -56,4 +56,18 @@
  */
 #define ROBOT_CONFIG_GRIPPER_CLOSE_DELAY_MS   300
 
+/**
+ * Closed-loop grip verification.
+ *
+ * After every pickup / place on a board square the planner waits for a
+ * fresh debounced scan (at most VERIFY_TIMEOUT_MS) and checks the square's
+ * occupancy. On a miss the grip is retried up to GRIP_RETRIES times, each
+ * attempt nudged by GRIP_RETRY_XY_STEPS in a different direction and
+ * GRIP_RETRY_Z_STEPS deeper than the nominal pick height.
+ */
+#define ROBOT_CONFIG_VERIFY_TIMEOUT_MS        1000
+#define ROBOT_CONFIG_GRIP_RETRIES             2
+#define ROBOT_CONFIG_GRIP_RETRY_XY_STEPS      40
+#define ROBOT_CONFIG_GRIP_RETRY_Z_STEPS       40
+
 #endif /* ROBOT_CONFIG_H */
@@ -5,6 +5,9 @@
 #include <stdbool.h>
 #include "movement_planner.h"
 
+/* Planned actions waiting for the robot; also the largest batch accepted */
+#define ROBOT_ACTION_QUEUE_DEPTH 8
+
 typedef struct
 {
     int32_t x;
@@ -111,15 +114,46 @@ typedef void (*robot_action_complete_cb_t)(planner_result_t result,
  */
 void robot_controller_set_action_complete_cb(robot_action_complete_cb_t cb);
 
+/**
+ * @brief Callback invoked by robot_controller_task when the robot goes from
+ *        idle to moving or homing. Runs on the robot thread; keep it short.
+ */
+typedef void (*robot_motion_start_cb_t)(void);
+
+/**
+ * @brief Register a callback to be called when the robot starts moving.
+ */
+void robot_controller_set_motion_start_cb(robot_motion_start_cb_t cb);
+
 /**
  * @brief Enqueue a chess action for execution by robot_controller_task.
  *
- * The action is placed in an internal ring buffer (capacity 4). When the
+ * The action is placed in an internal ring buffer (capacity
+ * ROBOT_ACTION_QUEUE_DEPTH). When the
  * robot is idle (and not homing), the task dequeues and executes it.
+ * The enqueue, dequeue and completion times are added to the action's
+ * trace; an unset trace starts at the enqueue.
  *
  * @param action  Fully populated planner_action_t.
  * @return 0 on success, -ENOMSG if the queue is full.
  */
 int robot_controller_enqueue_action(const planner_action_t *action);
 
+/**
+ * @brief Enqueue @p count actions as one batch, all or none.
+ *
+ * The actions run back to back in order. If one fails, the rest of the
+ * batch is not executed and completes with PLANNER_ERR_ABORTED, so the
+ * completion callback still sees every action once.
+ *
+ * @return 0 on success, -EINVAL for an empty or oversized batch, or
+ *         -ENOMSG if the queue cannot take the whole batch.
+ */
+int robot_controller_enqueue_batch(const planner_action_t *actions, size_t count);
+
+/**
+ * @brief Number of actions waiting in the queue, the running one excluded.
+ */
+uint32_t robot_controller_queue_depth(void);
+
 #endif
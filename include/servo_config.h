@@ -2,13 +2,11 @@
 #define SERVO_CONFIG_H
 
 #include <zephyr/devicetree.h>
-#include <zephyr/dt-bindings/gpio/gpio.h>
 #include <zephyr/sys/util.h>
 
-BUILD_ASSERT(DT_NODE_HAS_STATUS(DT_NODELABEL(servo_1), okay), "servo_1 DT node required");
+#define GRIPPER_SERVO_NODE DT_ALIAS(gripper_servo)
 
-#define GRIPPER_SERVO_GPIO_PORT DT_GPIO_CTLR(DT_NODELABEL(servo_1), control_gpios)
-#define GRIPPER_SERVO_GPIO_PIN  DT_GPIO_PIN (DT_NODELABEL(servo_1), control_gpios)
-#define GRIPPER_SERVO_GPIO_FLAGS DT_GPIO_FLAGS(DT_NODELABEL(servo_1), control_gpios)
+BUILD_ASSERT(DT_NODE_HAS_COMPAT_STATUS(GRIPPER_SERVO_NODE, custom_servo, okay),
+             "gripper-servo alias must point to an enabled custom,servo node");
 
 #endif
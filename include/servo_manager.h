@@ -3,8 +3,7 @@
 
 #include "servo_motor.h"
 
-#define MAX_SERVO_MOTORS 8
-
+/* Servo ids follow the devicetree order of the "custom,servo" nodes */
 typedef enum
 {
     SERVO_ID_1 = 0,
@@ -14,8 +13,10 @@ typedef enum
     SERVO_ID_MAX
 } servo_id_t;
 
+/**
+ * @brief Initialize every devicetree servo; the first SERVO_ID_MAX get ids.
+ */
 int servo_manager_init(void);
-int servo_manager_register_servo(servo_id_t id, servo_motor_t *servo);
 servo_motor_t *servo_manager_get_servo(servo_id_t id);
 int servo_manager_enable_all(bool enable);
 int servo_manager_set_all_angle(uint16_t angle_degrees);
@@ -3,7 +3,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/util.h>
 
 #define SERVO_MIN_ANGLE 0
 #define SERVO_MAX_ANGLE 180
@@ -13,7 +15,25 @@
 
 typedef struct servo_motor servo_motor_t;
 
-servo_motor_t *servo_motor_create(const struct device *gpio_port, uint32_t gpio_pin, gpio_dt_flags_t gpio_flags);
+/* One statically allocated servo per enabled "custom,servo" devicetree node */
+#define SERVO_MOTOR_DT_INDEX(node_id) _CONCAT(SERVO_MOTOR_INDEX_, DT_DEP_ORD(node_id))
+
+#define SERVO_MOTOR_INDEX_ENTRY(node_id) SERVO_MOTOR_DT_INDEX(node_id),
+
+enum {
+    DT_FOREACH_STATUS_OKAY(custom_servo, SERVO_MOTOR_INDEX_ENTRY)
+    SERVO_MOTOR_COUNT
+};
+
+/**
+ * @brief Servo of a "custom,servo" node, e.g. SERVO_MOTOR_DT_GET(DT_ALIAS(gripper_servo))
+ */
+#define SERVO_MOTOR_DT_GET(node_id) servo_motor_get(SERVO_MOTOR_DT_INDEX(node_id))
+
+/**
+ * @brief Servo @p index (0 to SERVO_MOTOR_COUNT - 1), NULL if out of range
+ */
+servo_motor_t *servo_motor_get(int index);
 int servo_motor_init(servo_motor_t *servo);
 int servo_motor_set_angle(servo_motor_t *servo, uint16_t angle_degrees);
 int servo_motor_set_pulse_width(servo_motor_t *servo, uint32_t pulse_us);
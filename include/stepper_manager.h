@@ -3,8 +3,7 @@
 
 #include "stepper_motor.h"
 
-#define MAX_STEPPER_MOTORS 8
-
+/* Axis roles; the devicetree aliases in stepper_config.h pick their motors */
 typedef enum
 {
     STEPPER_ID_X_AXIS = 0,
@@ -14,8 +13,12 @@ typedef enum
     STEPPER_ID_MAX
 } stepper_id_t;
 
+/**
+ * @brief Initialize every devicetree stepper and assign the axis roles.
+ *
+ * Motors without a role are still enabled, stepped and stopped with the rest.
+ */
 int stepper_manager_init(void);
-int stepper_manager_register_motor(stepper_id_t id, stepper_motor_t *motor);
 stepper_motor_t *stepper_manager_get_motor(stepper_id_t id);
 void stepper_manager_update_all(void);
 int stepper_manager_enable_all(bool enable);
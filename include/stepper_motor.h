@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
 
 typedef enum
 {
@@ -22,9 +24,33 @@ typedef struct stepper_motor stepper_motor_t;
 
 typedef void (*stepper_move_complete_callback_t)(stepper_motor_t *motor);
 
-stepper_motor_t *stepper_motor_create(const struct device *pulse_port, uint32_t pulse_pin,
-                                      const struct device *dir_port, uint32_t dir_pin,
-                                      const struct device *enable_port, uint32_t enable_pin);
+/*
+ * One statically allocated motor per enabled "custom,stepper" devicetree
+ * node, numbered in devicetree order. Adding a motor is an overlay change.
+ */
+#define STEPPER_MOTOR_DT_INDEX(node_id) _CONCAT(STEPPER_MOTOR_INDEX_, DT_DEP_ORD(node_id))
+
+#define STEPPER_MOTOR_INDEX_ENTRY(node_id) STEPPER_MOTOR_DT_INDEX(node_id),
+
+enum {
+    DT_FOREACH_STATUS_OKAY(custom_stepper, STEPPER_MOTOR_INDEX_ENTRY)
+    STEPPER_MOTOR_COUNT
+};
+
+/**
+ * @brief Motor of a "custom,stepper" node, e.g. STEPPER_MOTOR_DT_GET(DT_ALIAS(stepper_x))
+ */
+#define STEPPER_MOTOR_DT_GET(node_id) stepper_motor_get(STEPPER_MOTOR_DT_INDEX(node_id))
+
+/**
+ * @brief Motor @p index (0 to STEPPER_MOTOR_COUNT - 1), NULL if out of range
+ */
+stepper_motor_t *stepper_motor_get(int index);
+
+/**
+ * @brief Devicetree node name of the motor, for logs
+ */
+const char *stepper_motor_name(const stepper_motor_t *motor);
 
 int stepper_motor_init(stepper_motor_t *motor);
 int stepper_motor_enable(stepper_motor_t *motor, bool enable);
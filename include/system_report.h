@@ -0,0 +1,27 @@
+#ifndef SYSTEM_REPORT_H
+#define SYSTEM_REPORT_H
+
+/**
+ * Memory headroom report, published on chess/diag/system/response.
+ *
+ * Lists every thread's stack size and the most of it ever used, the
+ * system heap's free, allocated and peak bytes, network packet and buffer
+ * pool usage, the MQTT ingress backlog and the action queue depth.
+ */
+
+/**
+ * @brief Start the periodic report if CONFIG_APP_SYSTEM_REPORT_PERIOD_S
+ *        is non-zero.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int system_report_init(void);
+
+/**
+ * @brief Build and publish one report now. Safe from any thread.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int system_report_publish(void);
+
+#endif /* SYSTEM_REPORT_H */
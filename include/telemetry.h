@@ -0,0 +1,17 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/**
+ * @brief Start the gantry telemetry stream (CONFIG_APP_TELEMETRY).
+ *
+ * A timer samples position, motor states and planner phase at
+ * CONFIG_APP_TELEMETRY_RATE_HZ while the robot moves or homes. Samples are
+ * batched into chess/robot/telemetry/bin messages (layout in wire_format.h),
+ * so a live view costs a handful of publishes per second instead of one per
+ * sample.
+ *
+ * @return 0 on success, negative errno on failure
+ */
+int telemetry_init(void);
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,165 @@
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/sys/byteorder.h>
+
+/*
+ * Binary encodings published on the .../bin topics (CONFIG_APP_BINARY_TOPICS).
+ *
+ * All fields are little-endian and tightly packed. Every message starts with
+ * a version byte and a message type byte so host decoders can reject layouts
+ * they do not know. Layout changes bump WIRE_FORMAT_VERSION; asyncapi.yaml
+ * documents each layout byte by byte.
+ *
+ * Squares use the matrix numbering of the occupancy mask everywhere: index
+ * row * 8 + col, row 0 = rank 8 and col 0 = file a (square_index()). A square
+ * field holds that index, a mask has that bit set.
+ */
+
+#define WIRE_FORMAT_VERSION 1
+
+typedef enum {
+    WIRE_MSG_BOARD_STATE    = 1,
+    WIRE_MSG_ROBOT_STATUS   = 2,
+    WIRE_MSG_ROBOT_POSITION = 3,
+    WIRE_MSG_TELEMETRY      = 4,
+} wire_msg_type_t;
+
+/*
+ * chess/board/state/bin, 20 bytes
+ *
+ *  0  u8   version
+ *  1  u8   type (WIRE_MSG_BOARD_STATE)
+ *  2  u16  reserved (0)
+ *  4  u32  timestamp (ms since boot)
+ *  8  u32  move count
+ * 12  u64  occupied mask
+ */
+#define WIRE_BOARD_STATE_SIZE 20
+
+static inline size_t wire_encode_board_state(uint8_t *buf, uint64_t occupied,
+                                             uint32_t move_count, uint32_t timestamp)
+{
+    buf[0] = WIRE_FORMAT_VERSION;
+    buf[1] = WIRE_MSG_BOARD_STATE;
+    sys_put_le16(0, &buf[2]);
+    sys_put_le32(timestamp, &buf[4]);
+    sys_put_le32(move_count, &buf[8]);
+    sys_put_le64(occupied, &buf[12]);
+    return WIRE_BOARD_STATE_SIZE;
+}
+
+/*
+ * chess/robot/status/bin, 12 bytes
+ *
+ *  0  u8   version
+ *  1  u8   type (WIRE_MSG_ROBOT_STATUS)
+ *  2  i8   planner result (0 = ok)
+ *  3  u8   action type (0xFF if none)
+ *  4  u8   from square (0xFF if none)
+ *  5  u8   to square   (0xFF if none)
+ *  6  u16  reserved (0)
+ *  8  u32  timestamp (ms since boot)
+ */
+#define WIRE_ROBOT_STATUS_SIZE 12
+#define WIRE_NONE              0xFF
+
+static inline size_t wire_encode_robot_status(uint8_t *buf, int8_t result, uint8_t action_type,
+                                              uint8_t from, uint8_t to, uint32_t timestamp)
+{
+    buf[0] = WIRE_FORMAT_VERSION;
+    buf[1] = WIRE_MSG_ROBOT_STATUS;
+    buf[2] = (uint8_t)result;
+    buf[3] = action_type;
+    buf[4] = from;
+    buf[5] = to;
+    sys_put_le16(0, &buf[6]);
+    sys_put_le32(timestamp, &buf[8]);
+    return WIRE_ROBOT_STATUS_SIZE;
+}
+
+/*
+ * chess/robot/position/bin, 20 bytes
+ *
+ *  0  u8   version
+ *  1  u8   type (WIRE_MSG_ROBOT_POSITION)
+ *  2  u8   flags (bit 0: robot busy)
+ *  3  u8   reserved (0)
+ *  4  i32  x (steps)
+ *  8  i32  y (steps)
+ * 12  i32  z (steps)
+ * 16  u32  timestamp (ms since boot)
+ */
+#define WIRE_ROBOT_POSITION_SIZE 20
+#define WIRE_POSITION_FLAG_BUSY  (1U << 0)
+
+static inline size_t wire_encode_robot_position(uint8_t *buf, int32_t x, int32_t y, int32_t z,
+                                                uint8_t flags, uint32_t timestamp)
+{
+    buf[0] = WIRE_FORMAT_VERSION;
+    buf[1] = WIRE_MSG_ROBOT_POSITION;
+    buf[2] = flags;
+    buf[3] = 0;
+    sys_put_le32((uint32_t)x, &buf[4]);
+    sys_put_le32((uint32_t)y, &buf[8]);
+    sys_put_le32((uint32_t)z, &buf[12]);
+    sys_put_le32(timestamp, &buf[16]);
+    return WIRE_ROBOT_POSITION_SIZE;
+}
+
+/*
+ * chess/robot/telemetry/bin, 12-byte header followed by count samples
+ *
+ *  0  u8   version
+ *  1  u8   type (WIRE_MSG_TELEMETRY)
+ *  2  u8   sample count
+ *  3  u8   reserved (0)
+ *  4  u32  timestamp of the first sample (ms since boot)
+ *  8  u32  batch sequence number
+ *
+ * Each sample, 16 bytes:
+ *
+ *  0  u16  offset from the batch timestamp (ms)
+ *  2  i32  x (steps)
+ *  6  i32  y (steps)
+ * 10  i32  z (steps)
+ * 14  u8   flags (WIRE_TELEMETRY_FLAG_*)
+ * 15  u8   planner phase (planner_phase_t)
+ */
+#define WIRE_TELEMETRY_HEADER_SIZE 12
+#define WIRE_TELEMETRY_SAMPLE_SIZE 16
+#define WIRE_TELEMETRY_MAX_SAMPLES 14 /* keeps a batch in a small publish slot */
+
+#define WIRE_TELEMETRY_FLAG_BUSY      (1U << 0)
+#define WIRE_TELEMETRY_FLAG_XY_MOVING (1U << 1)
+#define WIRE_TELEMETRY_FLAG_Z_MOVING  (1U << 2)
+#define WIRE_TELEMETRY_FLAG_HOMING    (1U << 3)
+
+static inline size_t wire_encode_telemetry_header(uint8_t *buf, uint8_t count,
+                                                  uint32_t timestamp, uint32_t seq)
+{
+    buf[0] = WIRE_FORMAT_VERSION;
+    buf[1] = WIRE_MSG_TELEMETRY;
+    buf[2] = count;
+    buf[3] = 0;
+    sys_put_le32(timestamp, &buf[4]);
+    sys_put_le32(seq, &buf[8]);
+    return WIRE_TELEMETRY_HEADER_SIZE;
+}
+
+static inline size_t wire_encode_telemetry_sample(uint8_t *buf, uint16_t offset_ms,
+                                                  int32_t x, int32_t y, int32_t z,
+                                                  uint8_t flags, uint8_t phase)
+{
+    sys_put_le16(offset_ms, &buf[0]);
+    sys_put_le32((uint32_t)x, &buf[2]);
+    sys_put_le32((uint32_t)y, &buf[6]);
+    sys_put_le32((uint32_t)z, &buf[10]);
+    buf[14] = flags;
+    buf[15] = phase;
+    return WIRE_TELEMETRY_SAMPLE_SIZE;
+}
+
+#endif
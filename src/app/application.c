@@ -3,278 +3,1055 @@
 #include <cJSON.h>
 #include <string.h>
 #include "board_manager.h"
+#include "board_history.h"
 #include "mqtt_client.h"
+#include "mqtt_ingress.h"
 #include "robot_controller.h"
 #include "diagnostics.h"
+#include "telemetry.h"
+#include "system_report.h"
+#include "action_trace.h"
+#include "json_writer.h"
+#include "json_command.h"
+#include "wire_format.h"
+#include <zephyr/random/random.h>
 
 LOG_MODULE_REGISTER(application, LOG_LEVEL_INF);
 
-#define BOARD_SCAN_INTERVAL_MS 100
+/* Sized for the largest message built on the stack in each handler */
+#define MOVE_JSON_BUF_SIZE      192
+#define STATE_JSON_BUF_SIZE     128
+#define FULLSTATE_JSON_BUF_SIZE 256
+#define STATUS_JSON_BUF_SIZE    256
+#define ACTION_JSON_BUF_SIZE    320 /* action_complete with id and stage timings */
 
 /*
- * Event Handlers
-*/
-static void on_move_detected(const board_move_t *move)
+ * Retained full-board keyframe cadence. The full state topics (state,
+ * state/bin, fullstate) go out with it and on resync requests; every
+ * change in between is only a delta.
+ */
+#define BOARD_KEYFRAME_INTERVAL_MS 30000
+
+/*
+ * Delta stream bookkeeping. Every state change bumps seq, even when the
+ * delta could not be published, so subscribers see the gap and resync
+ * from the keyframe. epoch changes on every boot.
+ */
+static struct {
+    uint32_t epoch;
+    uint32_t seq;
+    uint64_t mask;
+    uint32_t moves;
+    uint32_t t;
+} board_stream;
+static struct k_spinlock board_stream_lock;
+
+/*
+ * Moves, robot moves and action results share one sequence number. They may
+ * reach the host late, replayed after a reconnect, and the host orders and
+ * de-duplicates them by seq together with their original timestamp.
+ */
+static atomic_t event_seq = ATOMIC_INIT(0);
+
+static uint32_t next_event_seq(void)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (!root) {
-        LOG_ERR("Failed to create JSON object");
+    return (uint32_t)atomic_inc(&event_seq) + 1;
+}
+
+static void keyframe_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(keyframe_work, keyframe_work_handler);
+
+static void publish_board_keyframe(void)
+{
+    char buf[STATE_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    k_spinlock_key_t key = k_spin_lock(&board_stream_lock);
+    uint32_t seq = board_stream.seq;
+    uint64_t mask = board_stream.mask;
+    uint32_t moves = board_stream.moves;
+    k_spin_unlock(&board_stream_lock, key);
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "keyframe");
+    jw_field_uint(&w, "epoch", board_stream.epoch);
+    jw_field_uint(&w, "seq", seq);
+    jw_field_hex64(&w, "mask", mask);
+    jw_field_uint(&w, "moves", moves);
+    jw_field_uint(&w, "t", k_uptime_get_32());
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
         return;
     }
 
-    cJSON_AddStringToObject(root, "type", "move");
+    int rc = app_mqtt_publish_retained("chess/board/keyframe", buf, len);
+    if (rc < 0) {
+        LOG_DBG("Failed to publish keyframe (rc=%d)", rc);
+    }
+}
 
-    cJSON *from = cJSON_CreateObject();
-    cJSON_AddNumberToObject(from, "row", move->from.row);
-    cJSON_AddNumberToObject(from, "col", move->from.col);
-    cJSON_AddItemToObject(root, "from", from);
+/* Full board on chess/board/state, state/bin and fullstate */
+static void publish_board_full(void)
+{
+    json_writer_t w;
+    int len;
 
-    cJSON *to = cJSON_CreateObject();
-    cJSON_AddNumberToObject(to, "row", move->to.row);
-    cJSON_AddNumberToObject(to, "col", move->to.col);
-    cJSON_AddItemToObject(root, "to", to);
+    k_spinlock_key_t key = k_spin_lock(&board_stream_lock);
+    uint64_t mask = board_stream.mask;
+    uint32_t moves = board_stream.moves;
+    uint32_t t = board_stream.t;
+    k_spin_unlock(&board_stream_lock, key);
 
-    cJSON_AddNumberToObject(root, "timestamp", move->timestamp);
+    /* Publish compact state (hex mask, move count, timestamp) */
+    char buf[STATE_JSON_BUF_SIZE];
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "state");
+    jw_field_hex64(&w, "occupied", mask);
+    jw_field_uint(&w, "moves", moves);
+    jw_field_uint(&w, "timestamp", t);
+    jw_object_end(&w);
 
-    char *payload = cJSON_PrintUnformatted(root);
-    if (payload) {
-        int rc = app_mqtt_publish("chess/board/move", payload, strlen(payload));
+    len = jw_finish(&w);
+    if (len >= 0) {
+        int rc = app_mqtt_publish("chess/board/state", buf, len);
         if (rc < 0) {
-            LOG_WRN("Failed to publish move (rc=%d) - MQTT connected: %s", 
+            LOG_DBG("Failed to publish state (rc=%d) - MQTT connected: %s", 
                     rc, app_mqtt_is_connected() ? "yes" : "no");
-        } else {
-            LOG_INF("Published move to MQTT");
         }
-        cJSON_free(payload);
     }
 
-    cJSON_Delete(root);
+    if (IS_ENABLED(CONFIG_APP_BINARY_TOPICS)) {
+        uint8_t bin[WIRE_BOARD_STATE_SIZE];
+        size_t bin_len = wire_encode_board_state(bin, mask, moves, t);
+        app_mqtt_publish("chess/board/state/bin", (const char *)bin, bin_len);
+    }
+
+    /* Publish full board grid as array to chess/board/fullstate */
+    char full[FULLSTATE_JSON_BUF_SIZE];
+    jw_init(&w, full, sizeof(full));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "fullstate");
+    jw_field_uint(&w, "timestamp", t);
+    jw_field_array_begin(&w, "board");
+    for (int r = 0; r < CHESS_BOARD_SIZE; r++) {
+        jw_array_begin(&w);
+        for (int c = 0; c < CHESS_BOARD_SIZE; c++) {
+            jw_uint(&w, (mask >> (r * CHESS_BOARD_SIZE + c)) & 1U);
+        }
+        jw_array_end(&w);
+    }
+    jw_array_end(&w);
+    jw_object_end(&w);
+
+    len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Fullstate JSON does not fit in %d bytes", FULLSTATE_JSON_BUF_SIZE);
+        return;
+    }
+
+    int rc = app_mqtt_publish("chess/board/fullstate", full, len);
+    if (rc < 0) {
+        LOG_DBG("Failed to publish fullstate (rc=%d) - MQTT connected: %s", 
+                rc, app_mqtt_is_connected() ? "yes" : "no");
+    }
 }
 
-static void on_state_changed(const chess_board_state_t *state)
+static void keyframe_work_handler(struct k_work *work)
 {
-    /* Publish compact state (hex mask, move count, timestamp) */
-    cJSON *root = cJSON_CreateObject();
-    if (!root) {
-        LOG_ERR("Failed to create JSON object");
+    publish_board_keyframe();
+    publish_board_full();
+    k_work_reschedule(&keyframe_work, K_MSEC(BOARD_KEYFRAME_INTERVAL_MS));
+}
+
+static void publish_board_delta(const chess_board_state_t *state)
+{
+    char buf[STATE_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    k_spinlock_key_t key = k_spin_lock(&board_stream_lock);
+    uint64_t xor_mask = state->occupied_mask ^ board_stream.mask;
+    uint32_t seq = ++board_stream.seq;
+    board_stream.mask = state->occupied_mask;
+    board_stream.moves = state->move_count;
+    board_stream.t = state->last_update_time;
+    k_spin_unlock(&board_stream_lock, key);
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "delta");
+    jw_field_uint(&w, "epoch", board_stream.epoch);
+    jw_field_uint(&w, "seq", seq);
+    jw_field_hex64(&w, "xor", xor_mask);
+    jw_field_uint(&w, "t", state->last_update_time);
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
         return;
     }
 
-    cJSON_AddStringToObject(root, "type", "state");
+    int rc = app_mqtt_publish("chess/board/delta", buf, len);
+    if (rc < 0) {
+        LOG_DBG("Failed to publish delta %u (rc=%d)", seq, rc);
+    }
+}
 
-    char mask_str[20];
-    snprintf(mask_str, sizeof(mask_str), "0x%016llx", state->occupied_mask);
-    cJSON_AddStringToObject(root, "occupied", mask_str);
+static void publish_robot_position_bin(void)
+{
+    uint8_t buf[WIRE_ROBOT_POSITION_SIZE];
+    robot_position_t pos = robot_controller_get_position();
+    uint8_t flags = robot_controller_is_busy() ? WIRE_POSITION_FLAG_BUSY : 0;
 
-    cJSON_AddNumberToObject(root, "moves", state->move_count);
-    cJSON_AddNumberToObject(root, "timestamp", state->last_update_time);
+    size_t len = wire_encode_robot_position(buf, pos.x, pos.y, pos.z, flags, k_uptime_get_32());
+    app_mqtt_publish("chess/robot/position/bin", (const char *)buf, len);
+}
 
-    char *payload = cJSON_PrintUnformatted(root);
-    if (payload) {
-        int rc = app_mqtt_publish("chess/board/state", payload, strlen(payload));
-        if (rc < 0) {
-            LOG_DBG("Failed to publish state (rc=%d) - MQTT connected: %s", 
-                    rc, app_mqtt_is_connected() ? "yes" : "no");
-        }
-        cJSON_free(payload);
+/*
+ * Event Handlers
+*/
+static void on_move_detected(const board_move_t *move)
+{
+    char buf[MOVE_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "move");
+    jw_field_uint(&w, "seq", next_event_seq());
+
+    jw_field_object_begin(&w, "from");
+    jw_field_uint(&w, "row", move->from.row);
+    jw_field_uint(&w, "col", move->from.col);
+    jw_object_end(&w);
+
+    jw_field_object_begin(&w, "to");
+    jw_field_uint(&w, "row", move->to.row);
+    jw_field_uint(&w, "col", move->to.col);
+    jw_object_end(&w);
+
+    jw_field_uint(&w, "timestamp", move->timestamp);
+    jw_field_uint(&w, "timestamp_us", move->timestamp_us);
+    if (move->flags & BOARD_MOVE_FLAG_REPLAY) {
+        jw_field_bool(&w, "replay", true);
     }
-    cJSON_Delete(root);
+    jw_object_end(&w);
 
-    /* Publish full board grid as array to chess/board/fullstate */
-    cJSON *full = cJSON_CreateObject();
-    if (!full) {
-        LOG_ERR("Failed to create fullstate JSON object");
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Move JSON does not fit in %d bytes", MOVE_JSON_BUF_SIZE);
         return;
     }
-    cJSON_AddStringToObject(full, "type", "fullstate");
-    cJSON_AddNumberToObject(full, "timestamp", state->last_update_time);
-    cJSON *rows = cJSON_CreateArray();
-    for (int r = 0; r < CHESS_BOARD_SIZE; r++) {
-        cJSON *row = cJSON_CreateArray();
-        for (int c = 0; c < CHESS_BOARD_SIZE; c++) {
-            int occ = (state->occupied_mask & (1ULL << (r * CHESS_BOARD_SIZE + c))) ? 1 : 0;
-            cJSON_AddItemToArray(row, cJSON_CreateNumber(occ));
-        }
-        cJSON_AddItemToArray(rows, row);
+
+    int rc = app_mqtt_publish("chess/board/move", buf, len);
+    if (rc < 0) {
+        LOG_WRN("Failed to publish move (rc=%d) - MQTT connected: %s", 
+                rc, app_mqtt_is_connected() ? "yes" : "no");
+    } else {
+        LOG_INF("Published move to MQTT");
     }
-    cJSON_AddItemToObject(full, "board", rows);
-    char *full_payload = cJSON_PrintUnformatted(full);
-    if (full_payload) {
-        int rc = app_mqtt_publish("chess/board/fullstate", full_payload, strlen(full_payload));
-        if (rc < 0) {
-            LOG_DBG("Failed to publish fullstate (rc=%d) - MQTT connected: %s", 
-                    rc, app_mqtt_is_connected() ? "yes" : "no");
-        }
-        cJSON_free(full_payload);
+}
+
+static void on_state_changed(const chess_board_state_t *state)
+{
+    publish_board_delta(state);
+}
+
+static void on_robot_move_settled(const board_robot_move_t *robot_move)
+{
+    /* One consolidated event per robot action instead of raw square changes */
+    char buf[STATUS_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    const planner_action_t *action = &robot_move->action;
+    char from_str[3] = {'a' + action->from.file, '1' + action->from.rank, '\0'};
+    char to_str[3]   = {'a' + action->to.file,   '1' + action->to.rank,   '\0'};
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "robot_move");
+    jw_field_uint(&w, "seq", next_event_seq());
+    jw_field_bool(&w, "verified", robot_move->verified);
+    jw_field_int(&w, "result", (int)robot_move->result);
+    jw_field_int(&w, "action_type", (int)action->type);
+    jw_field_string(&w, "from", from_str);
+    jw_field_string(&w, "to", to_str);
+    jw_field_hex64(&w, "expected", robot_move->expected_mask);
+    jw_field_hex64(&w, "observed", robot_move->observed_mask);
+    jw_field_uint(&w, "timestamp", robot_move->timestamp);
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Robot move JSON does not fit in %d bytes", STATUS_JSON_BUF_SIZE);
+        return;
+    }
+
+    int rc = app_mqtt_publish("chess/board/robot_move", buf, len);
+    if (rc < 0) {
+        LOG_WRN("Failed to publish robot move (rc=%d) - MQTT connected: %s",
+                rc, app_mqtt_is_connected() ? "yes" : "no");
+    }
+}
+
+static void on_replay_finished(const board_replay_result_t *result)
+{
+    char buf[STATUS_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    uint64_t avg_cycles = result->frames ? result->total_cycles / result->frames : 0;
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "replay_result");
+    jw_field_string(&w, "source",
+                    result->request.source == BOARD_FRAME_RAW ? "raw" : "debounced");
+    jw_field_uint(&w, "from_us", result->request.from_us);
+    jw_field_uint(&w, "to_us", result->request.to_us);
+    jw_field_uint(&w, "frames", result->frames);
+    jw_field_uint(&w, "moves", result->moves);
+    jw_field_uint(&w, "missing", result->missing);
+    jw_field_uint(&w, "min_ns", k_cyc_to_ns_floor64(result->min_cycles));
+    jw_field_uint(&w, "max_ns", k_cyc_to_ns_floor64(result->max_cycles));
+    jw_field_uint(&w, "avg_ns", k_cyc_to_ns_floor64(avg_cycles));
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Replay result JSON does not fit in %d bytes", STATUS_JSON_BUF_SIZE);
+        return;
+    }
+
+    int rc = app_mqtt_publish("chess/board/history/replay/result", buf, len);
+    if (rc < 0) {
+        LOG_WRN("Failed to publish replay result (rc=%d)", rc);
+    }
+}
+
+/*
+ * Health reports carry three 64-entry arrays, too large for the scanning
+ * thread's stack. Only that thread publishes them.
+ */
+static char health_json_buf[1536];
+
+static void on_board_health(const board_health_t *health)
+{
+    json_writer_t w;
+
+    jw_init(&w, health_json_buf, sizeof(health_json_buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "board_health");
+    jw_field_hex64(&w, "masked", health->masked);
+    jw_field_hex64(&w, "flapping", health->flapping);
+    jw_field_uint(&w, "frames", health->frames);
+    jw_field_uint(&w, "window_ms", health->window_ms);
+
+    /* Per-square arrays indexed by matrix bit (row * 8 + col) */
+    jw_field_array_begin(&w, "transitions");
+    for (int sq = 0; sq < CHESS_BOARD_SIZE * CHESS_BOARD_SIZE; sq++) {
+        jw_uint(&w, health->transitions[sq]);
+    }
+    jw_array_end(&w);
+
+    jw_field_array_begin(&w, "window");
+    for (int sq = 0; sq < CHESS_BOARD_SIZE * CHESS_BOARD_SIZE; sq++) {
+        jw_uint(&w, health->window_transitions[sq]);
+    }
+    jw_array_end(&w);
+
+    jw_field_array_begin(&w, "stuck_ms");
+    for (int sq = 0; sq < CHESS_BOARD_SIZE * CHESS_BOARD_SIZE; sq++) {
+        jw_uint(&w, health->stuck_ms[sq]);
+    }
+    jw_array_end(&w);
+
+    jw_field_uint(&w, "timestamp", health->timestamp);
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Board health JSON does not fit in %zu bytes", sizeof(health_json_buf));
+        return;
+    }
+
+    int rc = app_mqtt_publish("chess/board/health", health_json_buf, len);
+    if (rc < 0) {
+        LOG_DBG("Failed to publish board health (rc=%d)", rc);
     }
-    cJSON_Delete(full);
 }
 
 /*
  * MQTT Message Handlers
 */
+struct ping_request {
+    int32_t seq;
+};
+
+static const struct json_obj_descr ping_descr[] = {
+    JSON_OBJ_DESCR_PRIM(struct ping_request, seq, JSON_TOK_NUMBER),
+};
+
 static void on_ping_received(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (!root) {
-        LOG_ERR("Failed to create JSON object");
+    char buf[STATUS_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    robot_position_t pos = robot_controller_get_position();
+
+    /* An optional {"seq":n} is echoed so the host can pair pongs with pings */
+    struct ping_request req = {0};
+    char scratch[JSON_COMMAND_MAX];
+    bool has_seq = false;
+
+    if (payload_len > 0) {
+        int64_t fields = json_command_parse(payload, payload_len, scratch, sizeof(scratch),
+                                            ping_descr, ARRAY_SIZE(ping_descr), &req);
+        has_seq = fields > 0 && (fields & BIT(0)) && req.seq >= 0;
+    }
+
+    /*
+     * Over MQTT 5.0 the seq may come as a user property and always goes back
+     * in one; a seq from the body is echoed in the body too, for v3 clients.
+     */
+    uint32_t seq = has_seq ? (uint32_t)req.seq : app_mqtt_rx_correlation_id();
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "status", "pong");
+    if (has_seq) {
+        jw_field_uint(&w, "seq", seq);
+    }
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+    jw_field_bool(&w, "robot_busy", robot_controller_is_busy());
+    jw_field_object_begin(&w, "position");
+    jw_field_int(&w, "x", pos.x);
+    jw_field_int(&w, "y", pos.y);
+    jw_field_int(&w, "z", pos.z);
+    jw_object_end(&w);
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Pong JSON does not fit in %d bytes", STATUS_JSON_BUF_SIZE);
         return;
     }
 
-    cJSON_AddStringToObject(root, "status", "pong");
-    cJSON_AddNumberToObject(root, "timestamp", k_uptime_get_32());
-    cJSON_AddBoolToObject(root, "robot_busy", robot_controller_is_busy());
+    int rc = app_mqtt_publish_correlated("chess/system/pong", buf, len, seq);
+    if (rc < 0) {
+        LOG_WRN("Failed to publish pong (rc=%d) - MQTT connected: %s", 
+                rc, app_mqtt_is_connected() ? "yes" : "no");
+    } else {
+        LOG_DBG("Responded to ping");
+    }
 
-    robot_position_t pos = robot_controller_get_position();
-    cJSON *position = cJSON_CreateObject();
-    cJSON_AddNumberToObject(position, "x", pos.x);
-    cJSON_AddNumberToObject(position, "y", pos.y);
-    cJSON_AddNumberToObject(position, "z", pos.z);
-    cJSON_AddItemToObject(root, "position", position);
-
-    char *response = cJSON_PrintUnformatted(root);
-    if (response) {
-        int rc = app_mqtt_publish("chess/system/pong", response, strlen(response));
-        if (rc < 0) {
-            LOG_WRN("Failed to publish pong (rc=%d) - MQTT connected: %s", 
-                    rc, app_mqtt_is_connected() ? "yes" : "no");
-        } else {
-            LOG_INF("Responded to ping");
+    if (IS_ENABLED(CONFIG_APP_BINARY_TOPICS)) {
+        publish_robot_position_bin();
+    }
+}
+
+/* Largest chess/robot/command accepted; a full batch of actions needs the room */
+#define ROBOT_COMMAND_JSON_MAX 768
+
+/* One chess_move action, given at the top level or as an element of "actions" */
+struct chess_action_request {
+    const char *action;
+    const char *from;
+    const char *to;
+    const char *captured;
+    const char *from2;
+    const char *to2;
+};
+
+static const struct json_obj_descr chess_action_descr[] = {
+    JSON_OBJ_DESCR_PRIM(struct chess_action_request, action,   JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct chess_action_request, from,     JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct chess_action_request, to,       JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct chess_action_request, captured, JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct chess_action_request, from2,    JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct chess_action_request, to2,      JSON_TOK_STRING),
+};
+
+/*
+ * chess/robot/command. One schema covers every command; which fields are
+ * required depends on "command".
+ */
+struct robot_command {
+    const char *command;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    int32_t speed;
+    const char *action;
+    const char *from;
+    const char *to;
+    const char *captured;
+    const char *from2;
+    const char *to2;
+    int32_t id;
+    struct chess_action_request actions[ROBOT_ACTION_QUEUE_DEPTH];
+    size_t actions_len;
+};
+
+/* Bit positions in the json_command_parse() result, same order as the descriptor */
+enum {
+    CMD_FIELD_COMMAND,
+    CMD_FIELD_X,
+    CMD_FIELD_Y,
+    CMD_FIELD_Z,
+    CMD_FIELD_SPEED,
+    CMD_FIELD_ACTION,
+    CMD_FIELD_FROM,
+    CMD_FIELD_TO,
+    CMD_FIELD_CAPTURED,
+    CMD_FIELD_FROM2,
+    CMD_FIELD_TO2,
+    CMD_FIELD_ID,
+    CMD_FIELD_ACTIONS,
+};
+
+static const struct json_obj_descr robot_command_descr[] = {
+    JSON_OBJ_DESCR_PRIM(struct robot_command, command,  JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, x,        JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, y,        JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, z,        JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, speed,    JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, action,   JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, from,     JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, to,       JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, captured, JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, from2,    JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, to2,      JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct robot_command, id,       JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_OBJ_ARRAY(struct robot_command, actions, ROBOT_ACTION_QUEUE_DEPTH,
+                             actions_len, chess_action_descr, ARRAY_SIZE(chess_action_descr)),
+};
+
+static const char *robot_command_missing(int64_t fields, uint32_t required)
+{
+    return json_command_missing(robot_command_descr, ARRAY_SIZE(robot_command_descr),
+                                fields, required);
+}
+
+/*
+ * Turn one chess_move action into a planner action. Absent fields are NULL.
+ * Logs the first problem and returns -EINVAL.
+ */
+static int parse_chess_action(const struct chess_action_request *req, planner_action_t *action)
+{
+    if (!req->action || !req->from) {
+        LOG_ERR("chess_move: missing required '%s' field", req->action ? "from" : "action");
+        return -EINVAL;
+    }
+
+    /* Map action string to enum */
+    if (strcmp(req->action, "move") == 0) {
+        action->type = PLANNER_ACTION_MOVE;
+    } else if (strcmp(req->action, "capture") == 0) {
+        action->type = PLANNER_ACTION_CAPTURE;
+    } else if (strcmp(req->action, "en_passant") == 0) {
+        action->type = PLANNER_ACTION_EN_PASSANT;
+    } else if (strcmp(req->action, "castle") == 0) {
+        action->type = PLANNER_ACTION_CASTLE;
+    } else if (strcmp(req->action, "remove") == 0) {
+        action->type = PLANNER_ACTION_REMOVE;
+    } else {
+        LOG_ERR("chess_move: unknown action type '%s'", req->action);
+        return -EINVAL;
+    }
+
+    /* Parse primary from square */
+    if (movement_planner_parse_square(req->from, &action->from) != 0) {
+        LOG_ERR("chess_move: invalid 'from' square '%s'", req->from);
+        return -EINVAL;
+    }
+
+    /* Parse primary to square (optional for REMOVE) */
+    if (req->to && movement_planner_parse_square(req->to, &action->to) != 0) {
+        LOG_ERR("chess_move: invalid 'to' square '%s'", req->to);
+        return -EINVAL;
+    }
+
+    /* Parse optional en-passant captured pawn square */
+    if (req->captured && movement_planner_parse_square(req->captured, &action->captured) != 0) {
+        LOG_ERR("chess_move: invalid 'captured' square '%s'", req->captured);
+        return -EINVAL;
+    }
+
+    /* Parse optional castle king squares, only used as a pair */
+    if (req->from2 && req->to2) {
+        if (movement_planner_parse_square(req->from2, &action->from2) != 0 ||
+            movement_planner_parse_square(req->to2, &action->to2) != 0) {
+            LOG_ERR("chess_move: invalid castle squares '%s' -> '%s'", req->from2, req->to2);
+            return -EINVAL;
         }
-        cJSON_free(response);
     }
 
-    cJSON_Delete(root);
+    return 0;
+}
+
+/*
+ * Results of the batch being executed. Batches run back to back on the
+ * robot thread, the only caller of on_action_complete().
+ */
+static int8_t batch_results[ROBOT_ACTION_QUEUE_DEPTH];
+
+/*
+ * One chess/robot/status message per batch: "ok" or "error" with the
+ * result of every action once it has run, or "rejected" if it was never
+ * queued.
+ */
+static void publish_batch_status(const char *status, uint32_t id, bool id_in_body,
+                                 size_t count, const char *message, uint32_t total_us)
+{
+    char buf[ACTION_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type",   "batch_complete");
+    jw_field_uint(&w, "seq",      next_event_seq());
+    jw_field_string(&w, "status", status);
+    if (id && id_in_body) {
+        jw_field_uint(&w, "id", id);
+    }
+    jw_field_uint(&w, "count", count);
+    if (message) {
+        jw_field_string(&w, "message", message);
+    } else {
+        jw_field_array_begin(&w, "results");
+        for (size_t i = 0; i < count; i++) {
+            jw_int(&w, batch_results[i]);
+        }
+        jw_array_end(&w);
+        jw_field_uint(&w, "total_us", total_us);
+    }
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("batch_complete JSON does not fit in %d bytes", ACTION_JSON_BUF_SIZE);
+        return;
+    }
+
+    int rc = app_mqtt_publish_correlated("chess/robot/status", buf, len, id);
+    if (rc < 0) {
+        LOG_WRN("Failed to publish batch status (rc=%d)", rc);
+    }
+}
+
+/*
+ * chess_move with an "actions" array: every action is validated before any
+ * is queued, then the batch is queued as a unit and reported once.
+ */
+static void handle_chess_batch(const struct robot_command *cmd, int64_t fields)
+{
+    planner_action_t actions[ROBOT_ACTION_QUEUE_DEPTH];
+    bool id_in_body = fields & BIT(CMD_FIELD_ID);
+    uint32_t id = id_in_body ? (uint32_t)cmd->id : app_mqtt_rx_correlation_id();
+    int64_t rx_us = app_mqtt_rx_time_us();
+    size_t count = cmd->actions_len;
+    char message[48];
+
+    if (count == 0) {
+        publish_batch_status("rejected", id, id_in_body, 0, "Empty 'actions' array", 0);
+        return;
+    }
+
+    memset(actions, 0, count * sizeof(actions[0]));
+    for (size_t i = 0; i < count; i++) {
+        actions[i].id = id;
+        actions[i].id_in_body = id_in_body;
+        actions[i].trace.start_us = rx_us;
+        if (parse_chess_action(&cmd->actions[i], &actions[i]) < 0) {
+            snprintk(message, sizeof(message), "Invalid action %u", (unsigned int)i);
+            publish_batch_status("rejected", id, id_in_body, count, message, 0);
+            return;
+        }
+    }
+
+    uint32_t parsed_us = action_trace_mark(&actions[0].trace);
+    for (size_t i = 0; i < count; i++) {
+        actions[i].trace.parsed_us = parsed_us;
+    }
+
+    int ret = robot_controller_enqueue_batch(actions, count);
+    if (ret < 0) {
+        publish_batch_status("rejected", id, id_in_body, count, "Action queue full", 0);
+    } else {
+        LOG_INF("chess_move batch of %u actions queued", (unsigned int)count);
+    }
+}
+
+/*
+ * High-level chess move command.
+ *
+ * Expected JSON fields:
+ *   action   (string, required) – "move", "capture", "en_passant",
+ *                                  "castle", or "remove"
+ *   from     (string, required) – source square in UCI notation, e.g. "e2"
+ *   to       (string, optional) – destination square, e.g. "e4"
+ *                                 (not needed for "remove")
+ *   captured (string, optional) – en-passant captured pawn square
+ *   from2    (string, optional) – castle: king source square
+ *   to2      (string, optional) – castle: king destination square
+ *   id       (number, optional) – request id, echoed in the action_complete
+ *                                 status together with the stage timings;
+ *                                 over MQTT 5.0 it may instead come as a
+ *                                 "correlation-id" user property; the
+ *                                 result always carries the property and
+ *                                 echoes a body id in the body as well
+ *
+ * Instead of the action fields, "actions" may hold up to
+ * ROBOT_ACTION_QUEUE_DEPTH objects with the same fields; see
+ * handle_chess_batch().
+ */
+static void handle_chess_move(const struct robot_command *cmd, int64_t fields)
+{
+    if (fields & BIT(CMD_FIELD_ACTIONS)) {
+        handle_chess_batch(cmd, fields);
+        return;
+    }
+
+    const struct chess_action_request req = {
+        .action   = cmd->action,
+        .from     = cmd->from,
+        .to       = cmd->to,
+        .captured = cmd->captured,
+        .from2    = cmd->from2,
+        .to2      = cmd->to2,
+    };
+    planner_action_t action;
+    memset(&action, 0, sizeof(action));
+    action.trace.start_us = app_mqtt_rx_time_us();
+    action.id_in_body = fields & BIT(CMD_FIELD_ID);
+    action.id = action.id_in_body ? (uint32_t)cmd->id : app_mqtt_rx_correlation_id();
+
+    if (parse_chess_action(&req, &action) < 0) {
+        return;
+    }
+
+    action.trace.parsed_us = action_trace_mark(&action.trace);
+
+    int ret = robot_controller_enqueue_action(&action);
+    if (ret < 0) {
+        LOG_ERR("chess_move: action queue full (ret=%d)", ret);
+    } else {
+        LOG_INF("chess_move queued: %s %s -> %s", cmd->action, cmd->from,
+                cmd->to ? cmd->to : "graveyard");
+    }
 }
 
 static void on_robot_command_received(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    if (!root) {
-        LOG_ERR("Failed to parse robot command JSON");
+    struct robot_command cmd = {0};
+    char scratch[ROBOT_COMMAND_JSON_MAX];
+
+    int64_t fields = json_command_parse(payload, payload_len, scratch, sizeof(scratch),
+                                        robot_command_descr, ARRAY_SIZE(robot_command_descr),
+                                        &cmd);
+    if (fields < 0) {
+        LOG_ERR("Robot command rejected: %s", json_command_strerror(fields));
         return;
     }
 
-    cJSON *cmd = cJSON_GetObjectItem(root, "command");
-    if (!cmd || !cJSON_IsString(cmd)) {
-        LOG_ERR("Invalid command format");
-        cJSON_Delete(root);
+    if (robot_command_missing(fields, BIT(CMD_FIELD_COMMAND))) {
+        LOG_ERR("Robot command rejected: missing 'command' field");
         return;
     }
 
-    const char *command = cmd->valuestring;
-    LOG_INF("Robot command received: %s", command);
+    LOG_INF("Robot command received: %s", cmd.command);
 
-    if (strcmp(command, "move") == 0) {
-        cJSON *x = cJSON_GetObjectItem(root, "x");
-        cJSON *y = cJSON_GetObjectItem(root, "y");
-        cJSON *z = cJSON_GetObjectItem(root, "z");
-        cJSON *speed = cJSON_GetObjectItem(root, "speed");
-        
-        if (x && y && z) {
-            uint32_t speed_us = speed && cJSON_IsNumber(speed) ? speed->valueint : 1000;
-            robot_controller_move_to(x->valueint, y->valueint, z->valueint, speed_us);
-            LOG_INF("Moving to X=%d Y=%d Z=%d", x->valueint, y->valueint, z->valueint);
+    if (strcmp(cmd.command, "move") == 0) {
+        const char *missing = robot_command_missing(fields, BIT(CMD_FIELD_X) | BIT(CMD_FIELD_Y) |
+                                                            BIT(CMD_FIELD_Z));
+        if (missing) {
+            LOG_ERR("move: missing required '%s' field", missing);
+            return;
         }
-    } else if (strcmp(command, "home") == 0) {
+
+        uint32_t speed_us = (fields & BIT(CMD_FIELD_SPEED)) ? (uint32_t)cmd.speed : 1000;
+        robot_controller_move_to(cmd.x, cmd.y, cmd.z, speed_us);
+        LOG_INF("Moving to X=%d Y=%d Z=%d", cmd.x, cmd.y, cmd.z);
+    } else if (strcmp(cmd.command, "home") == 0) {
         robot_controller_home();
         LOG_INF("Homing robot");
-    } else if (strcmp(command, "gripper_open") == 0) {
+    } else if (strcmp(cmd.command, "gripper_open") == 0) {
         robot_controller_gripper_open();
         LOG_INF("Opening gripper");
-    } else if (strcmp(command, "gripper_close") == 0) {
+    } else if (strcmp(cmd.command, "gripper_close") == 0) {
         robot_controller_gripper_close();
         LOG_INF("Closing gripper");
+    } else if (strcmp(cmd.command, "chess_move") == 0) {
+        handle_chess_move(&cmd, fields);
+    } else {
+        LOG_WRN("Unknown robot command '%s'", cmd.command);
+    }
+}
 
-    } else if (strcmp(command, "chess_move") == 0) {
-        /*
-         * High-level chess move command.
-         *
-         * Expected JSON fields:
-         *   action   (string, required) – "move", "capture", "en_passant",
-         *                                  "castle", or "remove"
-         *   from     (string, required) – source square in UCI notation, e.g. "e2"
-         *   to       (string, optional) – destination square, e.g. "e4"
-         *                                 (not needed for "remove")
-         *   captured (string, optional) – en-passant captured pawn square
-         *   from2    (string, optional) – castle: king source square
-         *   to2      (string, optional) – castle: king destination square
-         */
-        cJSON *action_type_j = cJSON_GetObjectItem(root, "action");
-        cJSON *from_j        = cJSON_GetObjectItem(root, "from");
-        cJSON *to_j          = cJSON_GetObjectItem(root, "to");
-
-        if (!action_type_j || !cJSON_IsString(action_type_j) ||
-            !from_j        || !cJSON_IsString(from_j)) {
-            LOG_ERR("chess_move: missing required 'action' or 'from' field");
-            cJSON_Delete(root);
-            return;
+/* Frames per chess/board/history message */
+#define HISTORY_FRAMES_PER_MESSAGE 16
+
+/* History dumps are built on the MQTT ingress worker only */
+static char history_json_buf[2048];
+
+static void history_part_begin(json_writer_t *w, uint64_t now_us)
+{
+    jw_init(w, history_json_buf, sizeof(history_json_buf));
+    jw_object_begin(w);
+    jw_field_string(w, "type", "history");
+    jw_field_uint(w, "now_us", now_us);
+    jw_field_array_begin(w, "frames");
+}
+
+static bool history_part_publish(json_writer_t *w, int part, bool last)
+{
+    jw_array_end(w);
+    jw_field_int(w, "part", part);
+    jw_field_bool(w, "last", last);
+    jw_object_end(w);
+
+    int len = jw_finish(w);
+    if (len < 0) {
+        LOG_ERR("History part %d does not fit in %zu bytes", part, sizeof(history_json_buf));
+        return false;
+    }
+
+    int rc = app_mqtt_publish("chess/board/history", history_json_buf, len);
+    if (rc < 0) {
+        LOG_WRN("Failed to publish history part %d (rc=%d)", part, rc);
+        return false;
+    }
+    return true;
+}
+
+static void on_history_query_received(const char *topic, const uint8_t *payload, uint32_t payload_len)
+{
+    /* Expected JSON (all fields optional): {"from_us":0,"to_us":5000000,"kind":"raw|debounced|all"} */
+    uint64_t now_us = board_history_cycles_to_us(board_history_now_cycles());
+    uint64_t from_us = 0;
+    uint64_t to_us = now_us;
+    int kind_filter = -1;
+
+    cJSON *req = cJSON_ParseWithLength((const char *)payload, payload_len);
+    if (req) {
+        cJSON *from_j = cJSON_GetObjectItem(req, "from_us");
+        cJSON *to_j = cJSON_GetObjectItem(req, "to_us");
+        cJSON *kind_j = cJSON_GetObjectItem(req, "kind");
+
+        if (from_j && cJSON_IsNumber(from_j)) {
+            from_us = (uint64_t)from_j->valuedouble;
         }
+        if (to_j && cJSON_IsNumber(to_j)) {
+            to_us = (uint64_t)to_j->valuedouble;
+        }
+        if (kind_j && cJSON_IsString(kind_j)) {
+            if (strcmp(kind_j->valuestring, "raw") == 0) {
+                kind_filter = BOARD_FRAME_RAW;
+            } else if (strcmp(kind_j->valuestring, "debounced") == 0) {
+                kind_filter = BOARD_FRAME_DEBOUNCED;
+            }
+        }
+        cJSON_Delete(req);
+    }
 
-        planner_action_t action;
-        memset(&action, 0, sizeof(action));
-
-        /* Map action string to enum */
-        const char *atype = action_type_j->valuestring;
-        if (strcmp(atype, "move") == 0) {
-            action.type = PLANNER_ACTION_MOVE;
-        } else if (strcmp(atype, "capture") == 0) {
-            action.type = PLANNER_ACTION_CAPTURE;
-        } else if (strcmp(atype, "en_passant") == 0) {
-            action.type = PLANNER_ACTION_EN_PASSANT;
-        } else if (strcmp(atype, "castle") == 0) {
-            action.type = PLANNER_ACTION_CASTLE;
-        } else if (strcmp(atype, "remove") == 0) {
-            action.type = PLANNER_ACTION_REMOVE;
-        } else {
-            LOG_ERR("chess_move: unknown action type '%s'", atype);
-            cJSON_Delete(root);
-            return;
+    json_writer_t w;
+    int part = 0;
+    int in_part = 0;
+    uint32_t head = board_history_head();
+
+    history_part_begin(&w, now_us);
+
+    for (uint32_t seq = board_history_oldest(); seq != head; seq++) {
+        board_frame_t frame;
+
+        /* Frames overwritten while we read are simply skipped */
+        if (board_history_read(seq, &frame) < 0) {
+            continue;
+        }
+        if (kind_filter >= 0 && frame.kind != kind_filter) {
+            continue;
         }
 
-        /* Parse primary from square */
-        if (movement_planner_parse_square(from_j->valuestring, &action.from) != 0) {
-            LOG_ERR("chess_move: invalid 'from' square '%s'", from_j->valuestring);
-            cJSON_Delete(root);
-            return;
+        uint64_t t_us = board_history_cycles_to_us(frame.cycles);
+        if (t_us < from_us || t_us > to_us) {
+            continue;
         }
 
-        /* Parse primary to square (optional for REMOVE) */
-        if (to_j && cJSON_IsString(to_j)) {
-            if (movement_planner_parse_square(to_j->valuestring, &action.to) != 0) {
-                LOG_ERR("chess_move: invalid 'to' square '%s'", to_j->valuestring);
-                cJSON_Delete(root);
+        jw_object_begin(&w);
+        jw_field_uint(&w, "seq", frame.seq);
+        jw_field_uint(&w, "t_us", t_us);
+        jw_field_string(&w, "kind", frame.kind == BOARD_FRAME_RAW ? "raw" : "debounced");
+        jw_field_hex64(&w, "mask", frame.mask);
+        jw_object_end(&w);
+
+        if (++in_part == HISTORY_FRAMES_PER_MESSAGE) {
+            if (!history_part_publish(&w, part++, false)) {
                 return;
             }
+            history_part_begin(&w, now_us);
+            in_part = 0;
         }
+    }
 
-        /* Parse optional en-passant captured pawn square */
-        cJSON *captured_j = cJSON_GetObjectItem(root, "captured");
-        if (captured_j && cJSON_IsString(captured_j)) {
-            movement_planner_parse_square(captured_j->valuestring, &action.captured);
-        }
+    history_part_publish(&w, part, true);
+}
 
-        /* Parse optional castle king squares */
-        cJSON *from2_j = cJSON_GetObjectItem(root, "from2");
-        cJSON *to2_j   = cJSON_GetObjectItem(root, "to2");
-        if (from2_j && cJSON_IsString(from2_j) &&
-            to2_j   && cJSON_IsString(to2_j)) {
-            movement_planner_parse_square(from2_j->valuestring, &action.from2);
-            movement_planner_parse_square(to2_j->valuestring,   &action.to2);
-        }
+static void on_history_replay_received(const char *topic, const uint8_t *payload, uint32_t payload_len)
+{
+    /* Expected JSON: {"from_us":0,"to_us":5000000,"source":"raw|debounced","report":false} */
+    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
+    if (!root) {
+        LOG_ERR("Failed to parse replay request JSON");
+        return;
+    }
 
-        int ret = robot_controller_enqueue_action(&action);
-        if (ret < 0) {
-            LOG_ERR("chess_move: action queue full (ret=%d)", ret);
+    board_replay_request_t request = {
+        .from_us = 0,
+        .to_us = board_history_cycles_to_us(board_history_now_cycles()),
+        .source = BOARD_FRAME_DEBOUNCED,
+        .report_moves = false,
+    };
+
+    cJSON *from_j = cJSON_GetObjectItem(root, "from_us");
+    cJSON *to_j = cJSON_GetObjectItem(root, "to_us");
+    cJSON *source_j = cJSON_GetObjectItem(root, "source");
+    cJSON *report_j = cJSON_GetObjectItem(root, "report");
+
+    if (from_j && cJSON_IsNumber(from_j)) {
+        request.from_us = (uint64_t)from_j->valuedouble;
+    }
+    if (to_j && cJSON_IsNumber(to_j)) {
+        request.to_us = (uint64_t)to_j->valuedouble;
+    }
+    if (source_j && cJSON_IsString(source_j) && strcmp(source_j->valuestring, "raw") == 0) {
+        request.source = BOARD_FRAME_RAW;
+    }
+    if (report_j && cJSON_IsBool(report_j)) {
+        request.report_moves = cJSON_IsTrue(report_j);
+    }
+    cJSON_Delete(root);
+
+    int ret = board_manager_request_replay(&request);
+    if (ret < 0) {
+        LOG_WRN("Replay request rejected: %d", ret);
+    }
+}
+
+static void on_keyframe_request_received(const char *topic, const uint8_t *payload, uint32_t payload_len)
+{
+    /* Subscriber detected a sequence gap: send a keyframe and full state now, restart the interval */
+    k_work_reschedule(&keyframe_work, K_NO_WAIT);
+}
+
+/* @p error set: the request was rejected and the unchanged schedule is reported */
+static void publish_scan_config(const char *error)
+{
+    char buf[STATUS_JSON_BUF_SIZE];
+    json_writer_t w;
+    board_scan_config_t config;
+
+    board_manager_get_scan_config(&config);
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "scan_config");
+    jw_field_string(&w, "status", error ? "error" : "ok");
+    if (error) {
+        jw_field_string(&w, "error", error);
+    }
+    jw_field_uint(&w, "idle_ms", config.idle_interval_ms);
+    jw_field_uint(&w, "active_ms", config.active_interval_ms);
+    jw_field_uint(&w, "decay_ms", config.decay_ms);
+    jw_field_bool(&w, "human_turn", board_manager_is_human_turn());
+    jw_field_uint(&w, "interval_ms", board_manager_get_scan_interval_ms());
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len >= 0) {
+        app_mqtt_publish("chess/board/config/response", buf, len);
+    }
+}
+
+struct board_config_request {
+    int32_t idle_ms;
+    int32_t active_ms;
+    int32_t decay_ms;
+    bool human_turn;
+};
+
+enum {
+    CONFIG_FIELD_IDLE,
+    CONFIG_FIELD_ACTIVE,
+    CONFIG_FIELD_DECAY,
+    CONFIG_FIELD_HUMAN_TURN,
+};
+
+static const struct json_obj_descr board_config_descr[] = {
+    JSON_OBJ_DESCR_PRIM(struct board_config_request, idle_ms,    JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct board_config_request, active_ms,  JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct board_config_request, decay_ms,   JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct board_config_request, human_turn, JSON_TOK_TRUE),
+};
+
+static void on_board_config_received(const char *topic, const uint8_t *payload, uint32_t payload_len)
+{
+    /* Expected JSON (all fields optional): {"idle_ms":250,"active_ms":20,"decay_ms":3000,"human_turn":true} */
+    struct board_config_request req = {0};
+    char scratch[JSON_COMMAND_MAX];
+
+    int64_t fields = json_command_parse(payload, payload_len, scratch, sizeof(scratch),
+                                        board_config_descr, ARRAY_SIZE(board_config_descr), &req);
+    if (fields <= 0) {
+        /* Empty payload: just report the current schedule */
+        if (payload_len > 0) {
+            LOG_WRN("Board config ignored: %s", json_command_strerror(fields));
+            publish_scan_config(json_command_strerror(fields));
         } else {
-            LOG_INF("chess_move queued: %s %s -> %s",
-                    atype,
-                    from_j->valuestring,
-                    (to_j && cJSON_IsString(to_j)) ? to_j->valuestring : "graveyard");
+            publish_scan_config(NULL);
         }
+        return;
     }
 
-    cJSON_Delete(root);
+    if (((fields & BIT(CONFIG_FIELD_IDLE)) && req.idle_ms < 0) ||
+        ((fields & BIT(CONFIG_FIELD_ACTIVE)) && req.active_ms < 0) ||
+        ((fields & BIT(CONFIG_FIELD_DECAY)) && req.decay_ms < 0)) {
+        LOG_WRN("Rejected negative scan config");
+        publish_scan_config("negative interval");
+        return;
+    }
+
+    board_scan_config_t config;
+    board_manager_get_scan_config(&config);
+
+    if (fields & BIT(CONFIG_FIELD_IDLE)) {
+        config.idle_interval_ms = (uint32_t)req.idle_ms;
+    }
+    if (fields & BIT(CONFIG_FIELD_ACTIVE)) {
+        config.active_interval_ms = (uint32_t)req.active_ms;
+    }
+    if (fields & BIT(CONFIG_FIELD_DECAY)) {
+        config.decay_ms = (uint32_t)req.decay_ms;
+    }
+
+    /* All or nothing: a rejected schedule leaves human_turn alone too */
+    if (board_manager_set_scan_config(&config) < 0) {
+        LOG_WRN("Rejected scan config idle=%u active=%u decay=%u",
+                config.idle_interval_ms, config.active_interval_ms, config.decay_ms);
+        publish_scan_config("out of range");
+        return;
+    }
+
+    if (fields & BIT(CONFIG_FIELD_HUMAN_TURN)) {
+        board_manager_set_human_turn(req.human_turn);
+    }
+
+    publish_scan_config(NULL);
 }
 
 /*
@@ -284,35 +1061,89 @@ static void on_robot_command_received(const char *topic, const uint8_t *payload,
 static void on_action_complete(planner_result_t result,
                                const planner_action_t *action)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (!root) {
+    char buf[ACTION_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    /* Batched actions are reported together once the last one has run */
+    if (action && action->batch != 0) {
+        batch_results[action->batch_index] = (int8_t)result;
+        if (action->batch_index + 1 == action->batch_size) {
+            bool ok = true;
+            for (int i = 0; i < action->batch_size; i++) {
+                ok = ok && batch_results[i] == PLANNER_OK;
+            }
+            publish_batch_status(ok ? "ok" : "error", action->id, action->id_in_body,
+                                 action->batch_size, NULL, action->trace.completed_us);
+
+            if (IS_ENABLED(CONFIG_APP_BINARY_TOPICS)) {
+                publish_robot_position_bin();
+            }
+        }
         return;
     }
 
-    cJSON_AddStringToObject(root, "type",   "action_complete");
-    cJSON_AddStringToObject(root, "status", result == PLANNER_OK ? "ok" : "error");
-    cJSON_AddNumberToObject(root, "result", (int)result);
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type",   "action_complete");
+    jw_field_uint(&w, "seq",      next_event_seq());
+    jw_field_string(&w, "status", result == PLANNER_OK ? "ok" : "error");
+    jw_field_int(&w, "result", (int)result);
 
     if (action) {
         /* Encode the completed action in UCI notation */
         char from_str[3] = {'a' + action->from.file, '1' + action->from.rank, '\0'};
         char to_str[3]   = {'a' + action->to.file,   '1' + action->to.rank,   '\0'};
-        cJSON_AddStringToObject(root, "from",        from_str);
-        cJSON_AddStringToObject(root, "to",          to_str);
-        cJSON_AddNumberToObject(root, "action_type", (int)action->type);
-    }
+        jw_field_string(&w, "from",        from_str);
+        jw_field_string(&w, "to",          to_str);
+        jw_field_int(&w, "action_type", (int)action->type);
 
-    cJSON_AddNumberToObject(root, "timestamp", k_uptime_get_32());
+        if (action->id && action->id_in_body) {
+            jw_field_uint(&w, "id", action->id);
+        }
 
-    char *payload = cJSON_PrintUnformatted(root);
-    if (payload) {
-        int rc = app_mqtt_publish("chess/robot/status", payload, strlen(payload));
-        if (rc < 0) {
-            LOG_WRN("Failed to publish action_complete status (rc=%d)", rc);
+        /* Stage offsets from the MQTT receive: parsed, enqueued, dequeued, completed */
+        const planner_trace_t *trace = &action->trace;
+        jw_field_array_begin(&w, "trace_us");
+        jw_uint(&w, trace->parsed_us);
+        jw_uint(&w, trace->enqueued_us);
+        jw_uint(&w, trace->dequeued_us);
+        jw_uint(&w, trace->completed_us);
+        jw_array_end(&w);
+
+        jw_field_array_begin(&w, "primitives_us");
+        for (int i = 0; i < trace->primitives; i++) {
+            jw_uint(&w, trace->primitive_us[i]);
         }
-        cJSON_free(payload);
+        jw_array_end(&w);
+    }
+
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("action_complete JSON does not fit in %d bytes", ACTION_JSON_BUF_SIZE);
+        return;
+    }
+
+    int rc = app_mqtt_publish_correlated("chess/robot/status", buf, len,
+                                         action ? action->id : 0);
+    if (rc < 0) {
+        LOG_WRN("Failed to publish action_complete status (rc=%d)", rc);
+    }
+
+    if (IS_ENABLED(CONFIG_APP_BINARY_TOPICS)) {
+        uint8_t bin[WIRE_ROBOT_STATUS_SIZE];
+        size_t bin_len = wire_encode_robot_status(
+            bin, (int8_t)result,
+            action ? (uint8_t)action->type : WIRE_NONE,
+            action ? square_index(action->from.file, action->from.rank) : WIRE_NONE,
+            action ? square_index(action->to.file, action->to.rank) : WIRE_NONE,
+            k_uptime_get_32());
+        app_mqtt_publish("chess/robot/status/bin", (const char *)bin, bin_len);
+
+        publish_robot_position_bin();
     }
-    cJSON_Delete(root);
 }
 
 int application_init(void)
@@ -327,11 +1158,24 @@ int application_init(void)
         return ret;
     }
 
+    board_stream.epoch = sys_rand32_get();
+    board_stream.mask = board_manager_get_state()->occupied_mask;
+    board_stream.moves = board_manager_get_state()->move_count;
+    board_stream.t = board_manager_get_state()->last_update_time;
+    k_work_schedule(&keyframe_work, K_NO_WAIT);
+
     board_manager_register_move_callback(on_move_detected);
     board_manager_register_state_callback(on_state_changed);
+    board_manager_register_robot_move_callback(on_robot_move_settled);
+    board_manager_register_replay_callback(on_replay_finished);
+    board_manager_register_health_callback(on_board_health);
 
-    app_mqtt_subscribe("chess/system/ping", on_ping_received);
+    app_mqtt_subscribe_priority("chess/system/ping", on_ping_received, MQTT_PRIO_HIGH);
     app_mqtt_subscribe("chess/robot/command", on_robot_command_received);
+    app_mqtt_subscribe("chess/board/config", on_board_config_received);
+    app_mqtt_subscribe("chess/board/history/query", on_history_query_received);
+    app_mqtt_subscribe("chess/board/history/replay", on_history_replay_received);
+    app_mqtt_subscribe("chess/board/keyframe/request", on_keyframe_request_received);
 
     robot_controller_set_action_complete_cb(on_action_complete);
 
@@ -340,6 +1184,16 @@ int application_init(void)
         LOG_WRN("Failed to initialize diagnostics: %d", ret);
     }
 
+    ret = telemetry_init();
+    if (ret < 0) {
+        LOG_WRN("Failed to initialize telemetry: %d", ret);
+    }
+
+    ret = system_report_init();
+    if (ret < 0) {
+        LOG_WRN("Failed to initialize resource report: %d", ret);
+    }
+
     LOG_INF("Application initialized");
     return 0;
 }
@@ -348,6 +1202,6 @@ void application_task(void)
 {
     while (1) {
         board_manager_update();
-        k_sleep(K_MSEC(BOARD_SCAN_INTERVAL_MS));
+        board_manager_wait_next_scan();
     }
 }
@@ -1,8 +1,10 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
-#include <cJSON.h>
+#include <zephyr/sys/util.h>
 #include <string.h>
 #include "diagnostics.h"
+#include "json_writer.h"
+#include "json_command.h"
 #include "mqtt_client.h"
 #include "robot_controller.h"
 #include "stepper_manager.h"
@@ -10,9 +12,18 @@
 #include "stepper_config.h"
 #include "servo_manager.h"
 #include "servo_motor.h"
+#include "action_trace.h"
+#include "json_arena.h"
+#include "system_report.h"
 
 LOG_MODULE_REGISTER(diagnostics, LOG_LEVEL_INF);
 
+/* Large enough for the all-motors stepper status */
+#define DIAG_JSON_BUF_SIZE 384
+
+/* Every stage with a full histogram; sent in one large publish slot */
+#define DIAG_LATENCY_BUF_SIZE 2048
+
 /* ============================================================================
  * Helper functions
  * ============================================================================ */
@@ -37,21 +48,100 @@ static stepper_id_t stepper_name_to_id(const char *name)
     return STEPPER_ID_MAX; /* invalid */
 }
 
+/*
+ * Every diagnostics request is decoded with one schema; each handler checks
+ * the fields it needs. Bit positions follow the descriptor order.
+ */
+struct diag_request {
+    const char *motor;
+    const char *axis;
+    int32_t steps;
+    int32_t speed;
+    int32_t angle;
+    bool enable;
+};
+
+enum {
+    DIAG_FIELD_MOTOR,
+    DIAG_FIELD_AXIS,
+    DIAG_FIELD_STEPS,
+    DIAG_FIELD_SPEED,
+    DIAG_FIELD_ANGLE,
+    DIAG_FIELD_ENABLE,
+};
+
+static const struct json_obj_descr diag_request_descr[] = {
+    JSON_OBJ_DESCR_PRIM(struct diag_request, motor,  JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct diag_request, axis,   JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(struct diag_request, steps,  JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct diag_request, speed,  JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct diag_request, angle,  JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct diag_request, enable, JSON_TOK_TRUE),
+};
+
+/* @return Decoded field mask, or a negative errno for unusable payloads */
+static int64_t parse_diag_request(const uint8_t *payload, uint32_t payload_len,
+                                  char *scratch, struct diag_request *req)
+{
+    memset(req, 0, sizeof(*req));
+    return json_command_parse(payload, payload_len, scratch, JSON_COMMAND_MAX,
+                              diag_request_descr, ARRAY_SIZE(diag_request_descr), req);
+}
+
+static bool diag_has(int64_t fields, int field)
+{
+    return fields > 0 && (fields & BIT(field));
+}
+
+static void publish_diag_json(const char *topic, json_writer_t *w)
+{
+    int len = jw_finish(w);
+    if (len < 0) {
+        LOG_ERR("DIAG: Response for %s does not fit in %d bytes", topic, DIAG_JSON_BUF_SIZE);
+        return;
+    }
+    app_mqtt_publish(topic, w->buf, len);
+}
+
 static void publish_diag_response(const char *topic, const char *status, const char *message)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (!root) return;
-    
-    cJSON_AddStringToObject(root, "status", status);
-    cJSON_AddStringToObject(root, "message", message);
-    cJSON_AddNumberToObject(root, "timestamp", k_uptime_get_32());
-    
-    char *payload = cJSON_PrintUnformatted(root);
-    if (payload) {
-        app_mqtt_publish(topic, payload, strlen(payload));
-        cJSON_free(payload);
+    char buf[DIAG_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "status", status);
+    jw_field_string(&w, "message", message);
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+    jw_object_end(&w);
+
+    publish_diag_json(topic, &w);
+}
+
+/*
+ * Check the parse result and the required fields; on failure publish a
+ * precise error on @p response_topic and return false.
+ */
+static bool diag_require(const char *response_topic, int64_t fields, uint32_t required)
+{
+    char message[48];
+
+    if (fields < 0) {
+        LOG_ERR("DIAG: Request rejected: %s", json_command_strerror(fields));
+        publish_diag_response(response_topic, "error", json_command_strerror(fields));
+        return false;
     }
-    cJSON_Delete(root);
+
+    const char *missing = json_command_missing(diag_request_descr, ARRAY_SIZE(diag_request_descr),
+                                               fields, required);
+    if (missing) {
+        snprintk(message, sizeof(message), "Missing '%s' field", missing);
+        LOG_ERR("DIAG: %s", message);
+        publish_diag_response(response_topic, "error", message);
+        return false;
+    }
+
+    return true;
 }
 
 /* ============================================================================
@@ -61,41 +151,24 @@ static void publish_diag_response(const char *topic, const char *status, const c
 static void on_diag_stepper_move(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Expected JSON: {"motor": "x", "steps": 200, "speed": 1000} */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    if (!root) {
-        LOG_ERR("DIAG: Failed to parse stepper move JSON");
-        publish_diag_response("chess/diag/stepper/response", "error", "Invalid JSON");
-        return;
-    }
-
-    cJSON *motor_name = cJSON_GetObjectItem(root, "motor");
-    cJSON *steps = cJSON_GetObjectItem(root, "steps");
-    cJSON *speed = cJSON_GetObjectItem(root, "speed");
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
 
-    if (!motor_name || !cJSON_IsString(motor_name)) {
-        LOG_ERR("DIAG: Missing 'motor' field");
-        publish_diag_response("chess/diag/stepper/response", "error", "Missing 'motor' field");
-        cJSON_Delete(root);
+    if (!diag_require("chess/diag/stepper/response", fields,
+                      BIT(DIAG_FIELD_MOTOR) | BIT(DIAG_FIELD_STEPS))) {
         return;
     }
 
-    if (!steps || !cJSON_IsNumber(steps)) {
-        LOG_ERR("DIAG: Missing 'steps' field");
-        publish_diag_response("chess/diag/stepper/response", "error", "Missing 'steps' field");
-        cJSON_Delete(root);
-        return;
-    }
-
-    uint32_t speed_us = (speed && cJSON_IsNumber(speed)) ? (uint32_t)speed->valueint : STEPPER_DEFAULT_SPEED_US;
-    int32_t step_count = (int32_t)steps->valueint;
+    uint32_t speed_us = diag_has(fields, DIAG_FIELD_SPEED) ? (uint32_t)req.speed : STEPPER_DEFAULT_SPEED_US;
+    int32_t step_count = req.steps;
 
     /* Special handling: "y" targets the dual-drive pair (y1 + y2) */
-    if (strcmp(motor_name->valuestring, "y") == 0 || strcmp(motor_name->valuestring, "Y") == 0) {
+    if (strcmp(req.motor, "y") == 0 || strcmp(req.motor, "Y") == 0) {
         stepper_motor_t *y1 = stepper_manager_get_motor(STEPPER_ID_Y1_AXIS);
         stepper_motor_t *y2 = stepper_manager_get_motor(STEPPER_ID_Y2_AXIS);
         if (!y1 || !y2) {
             publish_diag_response("chess/diag/stepper/response", "error", "Y pair not registered");
-            cJSON_Delete(root);
             return;
         }
 
@@ -105,89 +178,76 @@ static void on_diag_stepper_move(const char *topic, const uint8_t *payload, uint
             publish_diag_response("chess/diag/stepper/response", "error", "Move failed (check enable)");
         } else {
             LOG_INF("DIAG: Moving Y pair by %d steps at %u us/step", step_count, speed_us);
-            cJSON *resp = cJSON_CreateObject();
-            cJSON_AddStringToObject(resp, "status", "ok");
-            cJSON_AddStringToObject(resp, "motor", "y");
-            cJSON_AddNumberToObject(resp, "steps", step_count);
-            cJSON_AddNumberToObject(resp, "speed_us", speed_us);
-            cJSON_AddNumberToObject(resp, "timestamp", k_uptime_get_32());
-            char *resp_payload = cJSON_PrintUnformatted(resp);
-            if (resp_payload) {
-                app_mqtt_publish("chess/diag/stepper/response", resp_payload, strlen(resp_payload));
-                cJSON_free(resp_payload);
-            }
-            cJSON_Delete(resp);
+            char buf[DIAG_JSON_BUF_SIZE];
+            json_writer_t w;
+            jw_init(&w, buf, sizeof(buf));
+            jw_object_begin(&w);
+            jw_field_string(&w, "status", "ok");
+            jw_field_string(&w, "motor", "y");
+            jw_field_int(&w, "steps", step_count);
+            jw_field_uint(&w, "speed_us", speed_us);
+            jw_field_uint(&w, "timestamp", k_uptime_get_32());
+            jw_object_end(&w);
+            publish_diag_json("chess/diag/stepper/response", &w);
         }
-        cJSON_Delete(root);
         return;
     }
 
-    stepper_id_t id = stepper_name_to_id(motor_name->valuestring);
+    stepper_id_t id = stepper_name_to_id(req.motor);
     if (id >= STEPPER_ID_MAX) {
-        LOG_ERR("DIAG: Unknown motor '%s'", motor_name->valuestring);
+        LOG_ERR("DIAG: Unknown motor '%s'", req.motor);
         publish_diag_response("chess/diag/stepper/response", "error", "Unknown motor");
-        cJSON_Delete(root);
         return;
     }
 
     stepper_motor_t *motor = stepper_manager_get_motor(id);
     if (!motor) {
-        LOG_ERR("DIAG: Motor %s not registered", motor_name->valuestring);
+        LOG_ERR("DIAG: Motor %s not registered", req.motor);
         publish_diag_response("chess/diag/stepper/response", "error", "Motor not registered");
-        cJSON_Delete(root);
         return;
     }
 
     int ret = stepper_motor_move_steps(motor, step_count, speed_us);
     if (ret < 0) {
-        LOG_ERR("DIAG: Failed to move motor %s: %d", motor_name->valuestring, ret);
+        LOG_ERR("DIAG: Failed to move motor %s: %d", req.motor, ret);
         publish_diag_response("chess/diag/stepper/response", "error", "Move failed (check enable)");
     } else {
         LOG_INF("DIAG: Moving motor %s by %d steps at %u us/step", 
-                motor_name->valuestring, step_count, speed_us);
+                req.motor, step_count, speed_us);
         
-        cJSON *resp = cJSON_CreateObject();
-        cJSON_AddStringToObject(resp, "status", "ok");
-        cJSON_AddStringToObject(resp, "motor", motor_name->valuestring);
-        cJSON_AddNumberToObject(resp, "steps", step_count);
-        cJSON_AddNumberToObject(resp, "speed_us", speed_us);
-        cJSON_AddNumberToObject(resp, "timestamp", k_uptime_get_32());
-        char *resp_payload = cJSON_PrintUnformatted(resp);
-        if (resp_payload) {
-            app_mqtt_publish("chess/diag/stepper/response", resp_payload, strlen(resp_payload));
-            cJSON_free(resp_payload);
-        }
-        cJSON_Delete(resp);
+        char buf[DIAG_JSON_BUF_SIZE];
+        json_writer_t w;
+        jw_init(&w, buf, sizeof(buf));
+        jw_object_begin(&w);
+        jw_field_string(&w, "status", "ok");
+        jw_field_string(&w, "motor", req.motor);
+        jw_field_int(&w, "steps", step_count);
+        jw_field_uint(&w, "speed_us", speed_us);
+        jw_field_uint(&w, "timestamp", k_uptime_get_32());
+        jw_object_end(&w);
+        publish_diag_json("chess/diag/stepper/response", &w);
     }
-
-    cJSON_Delete(root);
 }
 
 static void on_diag_stepper_stop(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
-    /* Expected JSON: {"motor": "x"} or {"motor": "all"} */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    if (!root) {
-        stepper_manager_stop_all();
-        LOG_INF("DIAG: Emergency stop all motors (no JSON)");
-        publish_diag_response("chess/diag/stepper/response", "ok", "All motors stopped");
-        return;
-    }
+    /* Expected JSON: {"motor": "x"} or {"motor": "all"}; anything else stops all */
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
 
-    cJSON *motor_name = cJSON_GetObjectItem(root, "motor");
-    if (!motor_name || !cJSON_IsString(motor_name)) {
+    if (!diag_has(fields, DIAG_FIELD_MOTOR)) {
         stepper_manager_stop_all();
         LOG_INF("DIAG: Stopping all motors");
         publish_diag_response("chess/diag/stepper/response", "ok", "All motors stopped");
-        cJSON_Delete(root);
         return;
     }
 
-    if (strcmp(motor_name->valuestring, "all") == 0) {
+    if (strcmp(req.motor, "all") == 0) {
         stepper_manager_stop_all();
         LOG_INF("DIAG: Stopping all motors");
         publish_diag_response("chess/diag/stepper/response", "ok", "All motors stopped");
-    } else if (strcmp(motor_name->valuestring, "y") == 0 || strcmp(motor_name->valuestring, "Y") == 0) {
+    } else if (strcmp(req.motor, "y") == 0 || strcmp(req.motor, "Y") == 0) {
         stepper_motor_t *y1 = stepper_manager_get_motor(STEPPER_ID_Y1_AXIS);
         stepper_motor_t *y2 = stepper_manager_get_motor(STEPPER_ID_Y2_AXIS);
         if (y1) stepper_motor_stop(y1);
@@ -195,116 +255,99 @@ static void on_diag_stepper_stop(const char *topic, const uint8_t *payload, uint
         LOG_INF("DIAG: Stopped Y pair");
         publish_diag_response("chess/diag/stepper/response", "ok", "Y pair stopped");
     } else {
-        stepper_id_t id = stepper_name_to_id(motor_name->valuestring);
+        stepper_id_t id = stepper_name_to_id(req.motor);
         if (id < STEPPER_ID_MAX) {
             stepper_motor_t *motor = stepper_manager_get_motor(id);
             if (motor) {
                 stepper_motor_stop(motor);
-                LOG_INF("DIAG: Stopped motor %s", motor_name->valuestring);
+                LOG_INF("DIAG: Stopped motor %s", req.motor);
                 publish_diag_response("chess/diag/stepper/response", "ok", "Motor stopped");
             }
         }
     }
-
-    cJSON_Delete(root);
 }
 
 static void on_diag_stepper_status(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Expected JSON: {"motor": "x"} or {} for all motors */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    cJSON *resp = cJSON_CreateObject();
-    if (!resp) {
-        if (root) cJSON_Delete(root);
-        return;
-    }
-
-    cJSON_AddStringToObject(resp, "type", "stepper_status");
-    cJSON_AddNumberToObject(resp, "timestamp", k_uptime_get_32());
-
-    cJSON *motor_name = root ? cJSON_GetObjectItem(root, "motor") : NULL;
-
-    if (motor_name && cJSON_IsString(motor_name) && strcmp(motor_name->valuestring, "all") != 0) {
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
+    char buf[DIAG_JSON_BUF_SIZE];
+    json_writer_t w;
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "stepper_status");
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+
+    if (diag_has(fields, DIAG_FIELD_MOTOR) && strcmp(req.motor, "all") != 0) {
         /* Single motor or Y pair status */
-        if (strcmp(motor_name->valuestring, "y") == 0 || strcmp(motor_name->valuestring, "Y") == 0) {
+        if (strcmp(req.motor, "y") == 0 || strcmp(req.motor, "Y") == 0) {
             stepper_motor_t *y1 = stepper_manager_get_motor(STEPPER_ID_Y1_AXIS);
             stepper_motor_t *y2 = stepper_manager_get_motor(STEPPER_ID_Y2_AXIS);
-            cJSON *m = cJSON_CreateObject();
+            jw_field_string(&w, "motor", "y");
+            jw_field_object_begin(&w, "y_pair");
             if (y1 && y2) {
-                cJSON_AddNumberToObject(m, "position_y1", stepper_motor_get_position(y1));
-                cJSON_AddNumberToObject(m, "position_y2", stepper_motor_get_position(y2));
-                cJSON_AddBoolToObject(m, "moving_y1", stepper_motor_is_moving(y1));
-                cJSON_AddBoolToObject(m, "moving_y2", stepper_motor_is_moving(y2));
-                cJSON_AddBoolToObject(m, "aligned", stepper_motor_get_position(y1) == stepper_motor_get_position(y2));
+                jw_field_int(&w, "position_y1", stepper_motor_get_position(y1));
+                jw_field_int(&w, "position_y2", stepper_motor_get_position(y2));
+                jw_field_bool(&w, "moving_y1", stepper_motor_is_moving(y1));
+                jw_field_bool(&w, "moving_y2", stepper_motor_is_moving(y2));
+                jw_field_bool(&w, "aligned", stepper_motor_get_position(y1) == stepper_motor_get_position(y2));
             } else {
-                cJSON_AddStringToObject(m, "status", "error");
-                cJSON_AddStringToObject(m, "message", "Y pair not found");
+                jw_field_string(&w, "status", "error");
+                jw_field_string(&w, "message", "Y pair not found");
             }
-            cJSON_AddItemToObject(resp, "motor", cJSON_CreateString("y"));
-            cJSON_AddItemToObject(resp, "y_pair", m);
+            jw_object_end(&w);
         } else {
-            stepper_id_t id = stepper_name_to_id(motor_name->valuestring);
+            stepper_id_t id = stepper_name_to_id(req.motor);
             stepper_motor_t *motor = (id < STEPPER_ID_MAX) ? stepper_manager_get_motor(id) : NULL;
             
             if (motor) {
-                cJSON_AddStringToObject(resp, "motor", motor_name->valuestring);
-                cJSON_AddNumberToObject(resp, "position", stepper_motor_get_position(motor));
-                cJSON_AddBoolToObject(resp, "moving", stepper_motor_is_moving(motor));
-                cJSON_AddNumberToObject(resp, "state", stepper_motor_get_state(motor));
+                jw_field_string(&w, "motor", req.motor);
+                jw_field_int(&w, "position", stepper_motor_get_position(motor));
+                jw_field_bool(&w, "moving", stepper_motor_is_moving(motor));
+                jw_field_int(&w, "state", stepper_motor_get_state(motor));
             } else {
-                cJSON_AddStringToObject(resp, "status", "error");
-                cJSON_AddStringToObject(resp, "message", "Motor not found");
+                jw_field_string(&w, "status", "error");
+                jw_field_string(&w, "message", "Motor not found");
             }
         }
     } else {
         /* All motors status */
-        cJSON *motors = cJSON_CreateObject();
+        jw_field_object_begin(&w, "motors");
         for (int i = 0; i < STEPPER_ID_MAX; i++) {
             stepper_motor_t *motor = stepper_manager_get_motor(i);
             if (motor) {
-                cJSON *m = cJSON_CreateObject();
-                cJSON_AddNumberToObject(m, "position", stepper_motor_get_position(motor));
-                cJSON_AddBoolToObject(m, "moving", stepper_motor_is_moving(motor));
-                cJSON_AddNumberToObject(m, "state", stepper_motor_get_state(motor));
-                cJSON_AddItemToObject(motors, stepper_id_to_name(i), m);
+                jw_field_object_begin(&w, stepper_id_to_name(i));
+                jw_field_int(&w, "position", stepper_motor_get_position(motor));
+                jw_field_bool(&w, "moving", stepper_motor_is_moving(motor));
+                jw_field_int(&w, "state", stepper_motor_get_state(motor));
+                jw_object_end(&w);
             }
         }
-        cJSON_AddItemToObject(resp, "motors", motors);
-        cJSON_AddBoolToObject(resp, "all_idle", stepper_manager_all_idle());
+        jw_object_end(&w);
+        jw_field_bool(&w, "all_idle", stepper_manager_all_idle());
     }
 
-    char *resp_payload = cJSON_PrintUnformatted(resp);
-    if (resp_payload) {
-        app_mqtt_publish("chess/diag/stepper/response", resp_payload, strlen(resp_payload));
-        cJSON_free(resp_payload);
-    }
-    cJSON_Delete(resp);
-    if (root) cJSON_Delete(root);
+    jw_object_end(&w);
+    publish_diag_json("chess/diag/stepper/response", &w);
 }
 
 static void on_diag_stepper_enable(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Expected JSON: {"motor": "x", "enable": true} or {"motor": "all", "enable": true} */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    if (!root) {
-        LOG_ERR("DIAG: Failed to parse stepper enable JSON");
-        publish_diag_response("chess/diag/stepper/response", "error", "Invalid JSON");
-        return;
-    }
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
 
-    cJSON *motor_name = cJSON_GetObjectItem(root, "motor");
-    cJSON *enable = cJSON_GetObjectItem(root, "enable");
-
-    if (!enable || !cJSON_IsBool(enable)) {
-        LOG_ERR("DIAG: Missing 'enable' field");
-        publish_diag_response("chess/diag/stepper/response", "error", "Missing 'enable' field");
-        cJSON_Delete(root);
+    if (!diag_require("chess/diag/stepper/response", fields, BIT(DIAG_FIELD_ENABLE))) {
         return;
     }
 
-    bool en = cJSON_IsTrue(enable);
+    bool en = req.enable;
 
-    if (!motor_name || !cJSON_IsString(motor_name) || strcmp(motor_name->valuestring, "all") == 0) {
+    if (!diag_has(fields, DIAG_FIELD_MOTOR) || strcmp(req.motor, "all") == 0) {
         int ret = stepper_manager_enable_all(en);
         if (ret < 0) {
             publish_diag_response("chess/diag/stepper/response", "error", "Enable all failed");
@@ -313,7 +356,7 @@ static void on_diag_stepper_enable(const char *topic, const uint8_t *payload, ui
             publish_diag_response("chess/diag/stepper/response", "ok", 
                                   en ? "All motors enabled" : "All motors disabled");
         }
-    } else if (strcmp(motor_name->valuestring, "y") == 0 || strcmp(motor_name->valuestring, "Y") == 0) {
+    } else if (strcmp(req.motor, "y") == 0 || strcmp(req.motor, "Y") == 0) {
         stepper_motor_t *y1 = stepper_manager_get_motor(STEPPER_ID_Y1_AXIS);
         stepper_motor_t *y2 = stepper_manager_get_motor(STEPPER_ID_Y2_AXIS);
         int ret1 = y1 ? stepper_motor_enable(y1, en) : -ENODEV;
@@ -326,7 +369,7 @@ static void on_diag_stepper_enable(const char *topic, const uint8_t *payload, ui
                                   en ? "Y pair enabled" : "Y pair disabled");
         }
     } else {
-        stepper_id_t id = stepper_name_to_id(motor_name->valuestring);
+        stepper_id_t id = stepper_name_to_id(req.motor);
         stepper_motor_t *motor = (id < STEPPER_ID_MAX) ? stepper_manager_get_motor(id) : NULL;
         
         if (motor) {
@@ -334,7 +377,7 @@ static void on_diag_stepper_enable(const char *topic, const uint8_t *payload, ui
             if (ret < 0) {
                 publish_diag_response("chess/diag/stepper/response", "error", "Enable failed");
             } else {
-                LOG_INF("DIAG: %s motor %s", en ? "Enabled" : "Disabled", motor_name->valuestring);
+                LOG_INF("DIAG: %s motor %s", en ? "Enabled" : "Disabled", req.motor);
                 publish_diag_response("chess/diag/stepper/response", "ok", 
                                       en ? "Motor enabled" : "Motor disabled");
             }
@@ -342,17 +385,16 @@ static void on_diag_stepper_enable(const char *topic, const uint8_t *payload, ui
             publish_diag_response("chess/diag/stepper/response", "error", "Motor not found");
         }
     }
-
-    cJSON_Delete(root);
 }
 
 static void on_diag_stepper_home(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Expected JSON: {"motor": "x"} or {"motor": "all"} - sets current position as 0 (no physical movement) */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    cJSON *motor_name = root ? cJSON_GetObjectItem(root, "motor") : NULL;
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
 
-    if (!motor_name || !cJSON_IsString(motor_name) || strcmp(motor_name->valuestring, "all") == 0) {
+    if (!diag_has(fields, DIAG_FIELD_MOTOR) || strcmp(req.motor, "all") == 0) {
         for (int i = 0; i < STEPPER_ID_MAX; i++) {
             stepper_motor_t *motor = stepper_manager_get_motor(i);
             if (motor) {
@@ -361,7 +403,7 @@ static void on_diag_stepper_home(const char *topic, const uint8_t *payload, uint
         }
         LOG_INF("DIAG: Zeroed all motor positions");
         publish_diag_response("chess/diag/stepper/response", "ok", "All motor positions zeroed");
-    } else if (strcmp(motor_name->valuestring, "y") == 0 || strcmp(motor_name->valuestring, "Y") == 0) {
+    } else if (strcmp(req.motor, "y") == 0 || strcmp(req.motor, "Y") == 0) {
         stepper_motor_t *y1 = stepper_manager_get_motor(STEPPER_ID_Y1_AXIS);
         stepper_motor_t *y2 = stepper_manager_get_motor(STEPPER_ID_Y2_AXIS);
         if (y1) stepper_motor_set_position(y1, 0);
@@ -369,19 +411,17 @@ static void on_diag_stepper_home(const char *topic, const uint8_t *payload, uint
         LOG_INF("DIAG: Zeroed Y pair positions");
         publish_diag_response("chess/diag/stepper/response", "ok", "Y pair positions zeroed");
     } else {
-        stepper_id_t id = stepper_name_to_id(motor_name->valuestring);
+        stepper_id_t id = stepper_name_to_id(req.motor);
         stepper_motor_t *motor = (id < STEPPER_ID_MAX) ? stepper_manager_get_motor(id) : NULL;
         
         if (motor) {
             stepper_motor_set_position(motor, 0);
-            LOG_INF("DIAG: Zeroed motor %s position", motor_name->valuestring);
+            LOG_INF("DIAG: Zeroed motor %s position", req.motor);
             publish_diag_response("chess/diag/stepper/response", "ok", "Motor position zeroed");
         } else {
             publish_diag_response("chess/diag/stepper/response", "error", "Motor not found");
         }
     }
-
-    if (root) cJSON_Delete(root);
 }
 
 /* ============================================================================
@@ -391,11 +431,12 @@ static void on_diag_stepper_home(const char *topic, const uint8_t *payload, uint
 static void on_diag_homing_start(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Expected JSON: {"axis": "x"} or {"axis": "all"} */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    cJSON *axis_name = root ? cJSON_GetObjectItem(root, "axis") : NULL;
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
     int ret;
 
-    if (!axis_name || !cJSON_IsString(axis_name) || strcmp(axis_name->valuestring, "all") == 0) {
+    if (!diag_has(fields, DIAG_FIELD_AXIS) || strcmp(req.axis, "all") == 0) {
         ret = robot_controller_home_all();
         if (ret < 0) {
             LOG_ERR("DIAG: Failed to start homing all axes: %d", ret);
@@ -405,7 +446,7 @@ static void on_diag_homing_start(const char *topic, const uint8_t *payload, uint
             publish_diag_response("chess/diag/homing/response", "ok", "Homing started (Z -> Y -> X)");
         }
     } else {
-        char axis = axis_name->valuestring[0];
+        char axis = req.axis[0];
         ret = robot_controller_home_axis(axis);
         if (ret < 0) {
             LOG_ERR("DIAG: Failed to start homing axis %c: %d", axis, ret);
@@ -413,31 +454,30 @@ static void on_diag_homing_start(const char *topic, const uint8_t *payload, uint
         } else {
             LOG_INF("DIAG: Started homing axis %c", axis);
             
-            cJSON *resp = cJSON_CreateObject();
-            cJSON_AddStringToObject(resp, "status", "ok");
-            cJSON_AddStringToObject(resp, "axis", axis_name->valuestring);
-            cJSON_AddStringToObject(resp, "message", "Homing started");
-            cJSON_AddNumberToObject(resp, "timestamp", k_uptime_get_32());
-            char *resp_payload = cJSON_PrintUnformatted(resp);
-            if (resp_payload) {
-                app_mqtt_publish("chess/diag/homing/response", resp_payload, strlen(resp_payload));
-                cJSON_free(resp_payload);
-            }
-            cJSON_Delete(resp);
+            char buf[DIAG_JSON_BUF_SIZE];
+            json_writer_t w;
+            jw_init(&w, buf, sizeof(buf));
+            jw_object_begin(&w);
+            jw_field_string(&w, "status", "ok");
+            jw_field_string(&w, "axis", req.axis);
+            jw_field_string(&w, "message", "Homing started");
+            jw_field_uint(&w, "timestamp", k_uptime_get_32());
+            jw_object_end(&w);
+            publish_diag_json("chess/diag/homing/response", &w);
         }
     }
-
-    if (root) cJSON_Delete(root);
 }
 
 static void on_diag_homing_status(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Returns current homing state */
-    cJSON *resp = cJSON_CreateObject();
-    if (!resp) return;
+    char buf[DIAG_JSON_BUF_SIZE];
+    json_writer_t w;
 
-    cJSON_AddStringToObject(resp, "type", "homing_status");
-    cJSON_AddNumberToObject(resp, "timestamp", k_uptime_get_32());
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "homing_status");
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
     
     /* Homing state */
     homing_state_t state = robot_controller_get_homing_state();
@@ -451,15 +491,11 @@ static void on_diag_homing_status(const char *topic, const uint8_t *payload, uin
         case HOMING_STATE_ERROR: state_str = "error"; break;
         default: state_str = "unknown"; break;
     }
-    cJSON_AddStringToObject(resp, "homing_state", state_str);
-    cJSON_AddBoolToObject(resp, "is_homing", robot_controller_is_homing());
+    jw_field_string(&w, "homing_state", state_str);
+    jw_field_bool(&w, "is_homing", robot_controller_is_homing());
+    jw_object_end(&w);
 
-    char *resp_payload = cJSON_PrintUnformatted(resp);
-    if (resp_payload) {
-        app_mqtt_publish("chess/diag/homing/response", resp_payload, strlen(resp_payload));
-        cJSON_free(resp_payload);
-    }
-    cJSON_Delete(resp);
+    publish_diag_json("chess/diag/homing/response", &w);
 }
 
 /* ============================================================================
@@ -469,18 +505,11 @@ static void on_diag_homing_status(const char *topic, const uint8_t *payload, uin
 static void on_diag_servo_set(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Expected JSON: {"angle": 90} */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    if (!root) {
-        LOG_ERR("DIAG: Failed to parse servo set JSON");
-        publish_diag_response("chess/diag/servo/response", "error", "Invalid JSON");
-        return;
-    }
-
-    cJSON *angle = cJSON_GetObjectItem(root, "angle");
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
 
-    if (!angle || !cJSON_IsNumber(angle)) {
-        publish_diag_response("chess/diag/servo/response", "error", "Missing 'angle' field");
-        cJSON_Delete(root);
+    if (!diag_require("chess/diag/servo/response", fields, BIT(DIAG_FIELD_ANGLE))) {
         return;
     }
 
@@ -489,51 +518,40 @@ static void on_diag_servo_set(const char *topic, const uint8_t *payload, uint32_
     if (ret < 0) {
         LOG_ERR("DIAG: Failed to enable gripper servo before set: %d", ret);
         publish_diag_response("chess/diag/servo/response", "error", "Failed to enable servo");
-        cJSON_Delete(root);
         return;
     }
 
-    ret = robot_controller_servo_set_angle(SERVO_ID_1, (uint16_t)angle->valueint);
+    ret = robot_controller_servo_set_angle(SERVO_ID_1, (uint16_t)req.angle);
     if (ret < 0) {
         LOG_ERR("DIAG: Failed to set gripper servo angle: %d", ret);
         publish_diag_response("chess/diag/servo/response", "error", "Failed to set angle");
     } else {
-        LOG_INF("DIAG: Set gripper servo to %d degrees", angle->valueint);
+        LOG_INF("DIAG: Set gripper servo to %d degrees", req.angle);
         
-        cJSON *resp = cJSON_CreateObject();
-        cJSON_AddStringToObject(resp, "status", "ok");
-        cJSON_AddNumberToObject(resp, "angle", angle->valueint);
-        cJSON_AddNumberToObject(resp, "timestamp", k_uptime_get_32());
-        char *resp_payload = cJSON_PrintUnformatted(resp);
-        if (resp_payload) {
-            app_mqtt_publish("chess/diag/servo/response", resp_payload, strlen(resp_payload));
-            cJSON_free(resp_payload);
-        }
-        cJSON_Delete(resp);
+        char buf[DIAG_JSON_BUF_SIZE];
+        json_writer_t w;
+        jw_init(&w, buf, sizeof(buf));
+        jw_object_begin(&w);
+        jw_field_string(&w, "status", "ok");
+        jw_field_int(&w, "angle", req.angle);
+        jw_field_uint(&w, "timestamp", k_uptime_get_32());
+        jw_object_end(&w);
+        publish_diag_json("chess/diag/servo/response", &w);
     }
-
-    cJSON_Delete(root);
 }
 
 static void on_diag_servo_enable(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
     /* Expected JSON: {"enable": true} */
-    cJSON *root = cJSON_ParseWithLength((const char *)payload, payload_len);
-    if (!root) {
-        LOG_ERR("DIAG: Failed to parse servo enable JSON");
-        publish_diag_response("chess/diag/servo/response", "error", "Invalid JSON");
-        return;
-    }
+    struct diag_request req;
+    char scratch[JSON_COMMAND_MAX];
+    int64_t fields = parse_diag_request(payload, payload_len, scratch, &req);
 
-    cJSON *enable = cJSON_GetObjectItem(root, "enable");
-
-    if (!enable || !cJSON_IsBool(enable)) {
-        publish_diag_response("chess/diag/servo/response", "error", "Missing 'enable' field");
-        cJSON_Delete(root);
+    if (!diag_require("chess/diag/servo/response", fields, BIT(DIAG_FIELD_ENABLE))) {
         return;
     }
 
-    bool en = cJSON_IsTrue(enable);
+    bool en = req.enable;
     int ret = robot_controller_servo_enable(SERVO_ID_1, en);
     if (ret < 0) {
         LOG_ERR("DIAG: Failed to %s gripper servo: %d", en ? "enable" : "disable", ret);
@@ -542,32 +560,168 @@ static void on_diag_servo_enable(const char *topic, const uint8_t *payload, uint
         LOG_INF("DIAG: %s gripper servo", en ? "Enabled" : "Disabled");
         publish_diag_response("chess/diag/servo/response", "ok", en ? "Servo enabled" : "Servo disabled");
     }
+}
+
+/* ============================================================================
+ * Action latency diagnostics
+ * ============================================================================ */
 
-    cJSON_Delete(root);
+static void on_diag_latency_status(const char *topic, const uint8_t *payload, uint32_t payload_len)
+{
+    /* Only the ingress worker runs handlers, so one static buffer is enough */
+    static char buf[DIAG_LATENCY_BUF_SIZE];
+    json_writer_t w;
+    action_latency_t lat;
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "latency");
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+
+    jw_field_object_begin(&w, "stages");
+    for (int stage = 0; stage < ACTION_STAGE_COUNT; stage++) {
+        action_trace_get(stage, &lat);
+
+        /* log2 buckets in µs, trailing empty ones left out */
+        int used = ACTION_TRACE_BUCKETS;
+        while (used > 0 && lat.buckets[used - 1] == 0) {
+            used--;
+        }
+
+        jw_field_object_begin(&w, action_stage_name(stage));
+        jw_field_uint(&w, "count", lat.count);
+        jw_field_uint(&w, "mean_us", lat.count ? lat.sum_us / lat.count : 0);
+        jw_field_uint(&w, "max_us", lat.max_us);
+        jw_field_array_begin(&w, "log2_us");
+        for (int i = 0; i < used; i++) {
+            jw_uint(&w, lat.buckets[i]);
+        }
+        jw_array_end(&w);
+        jw_object_end(&w);
+    }
+    jw_object_end(&w);
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("DIAG: Latency report does not fit in %d bytes", DIAG_LATENCY_BUF_SIZE);
+        return;
+    }
+    app_mqtt_publish("chess/diag/latency/response", buf, len);
+}
+
+static void on_diag_latency_reset(const char *topic, const uint8_t *payload, uint32_t payload_len)
+{
+    action_trace_reset();
+    publish_diag_response("chess/diag/latency/response", "ok", "Latency histograms cleared");
 }
 
 /* ============================================================================
- * Public API
+ * JSON arena diagnostics
  * ============================================================================ */
 
-int diagnostics_init(void)
+static void on_diag_json_arena(const char *topic, const uint8_t *payload, uint32_t payload_len)
 {
-    LOG_INF("Initializing diagnostics module");
+    char buf[DIAG_JSON_BUF_SIZE];
+    json_writer_t w;
+    json_arena_t arena;
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "type", "json_arena");
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+
+    jw_field_array_begin(&w, "arenas");
+    for (int i = 0; json_arena_get(i, &arena) == 0; i++) {
+        jw_object_begin(&w);
+        jw_field_string(&w, "name", arena.name);
+        jw_field_uint(&w, "size", arena.size);
+        jw_field_uint(&w, "high_water", arena.high_water);
+        jw_field_uint(&w, "fallbacks", arena.fallbacks);
+        jw_field_uint(&w, "resets", arena.resets);
+        jw_object_end(&w);
+    }
+    jw_array_end(&w);
+    jw_object_end(&w);
+    publish_diag_json("chess/diag/json/response", &w);
+}
+
+/* ============================================================================
+ * System resources
+ * ============================================================================ */
+
+static void on_diag_system_resources(const char *topic, const uint8_t *payload, uint32_t payload_len)
+{
+    int ret = system_report_publish();
+    if (ret < 0) {
+        LOG_ERR("DIAG: Failed to publish resource report: %d", ret);
+    }
+}
+
+/* ============================================================================
+ * Topic routing
+ * ============================================================================ */
 
-    /* Stepper diagnostics */
-    app_mqtt_subscribe("chess/diag/stepper/move", on_diag_stepper_move);
-    app_mqtt_subscribe("chess/diag/stepper/stop", on_diag_stepper_stop);
-    app_mqtt_subscribe("chess/diag/stepper/status", on_diag_stepper_status);
-    app_mqtt_subscribe("chess/diag/stepper/enable", on_diag_stepper_enable);
-    app_mqtt_subscribe("chess/diag/stepper/home", on_diag_stepper_home);
+typedef struct {
+    const char *command;
+    mqtt_message_callback_t handler;
+    mqtt_priority_t prio;
+} diag_route_t;
+
+/*
+ * Sub-topics below chess/diag/, each subscribed exactly. A chess/diag/#
+ * wildcard would also match our own .../response publishes, and the
+ * broker would send every one of them back to us.
+ */
+static const diag_route_t diag_routes[] = {
+    /* Stepper diagnostics; a stop is handled ahead of queued moves */
+    { "stepper/move",     on_diag_stepper_move,     MQTT_PRIO_NORMAL },
+    { "stepper/stop",     on_diag_stepper_stop,     MQTT_PRIO_HIGH },
+    { "stepper/status",   on_diag_stepper_status,   MQTT_PRIO_NORMAL },
+    { "stepper/enable",   on_diag_stepper_enable,   MQTT_PRIO_NORMAL },
+    { "stepper/home",     on_diag_stepper_home,     MQTT_PRIO_NORMAL },
 
     /* Homing diagnostics */
-    app_mqtt_subscribe("chess/diag/homing/start", on_diag_homing_start);
-    app_mqtt_subscribe("chess/diag/homing/status", on_diag_homing_status);
+    { "homing/start",     on_diag_homing_start,     MQTT_PRIO_NORMAL },
+    { "homing/status",    on_diag_homing_status,    MQTT_PRIO_NORMAL },
 
     /* Servo diagnostics */
-    app_mqtt_subscribe("chess/diag/servo/set", on_diag_servo_set);
-    app_mqtt_subscribe("chess/diag/servo/enable", on_diag_servo_enable);
+    { "servo/set",        on_diag_servo_set,        MQTT_PRIO_NORMAL },
+    { "servo/enable",     on_diag_servo_enable,     MQTT_PRIO_NORMAL },
+
+    /* Action latency */
+    { "latency/status",   on_diag_latency_status,   MQTT_PRIO_NORMAL },
+    { "latency/reset",    on_diag_latency_reset,    MQTT_PRIO_NORMAL },
+
+    /* cJSON arena usage */
+    { "json/arena",       on_diag_json_arena,       MQTT_PRIO_NORMAL },
+
+    /* Stack, heap and pool headroom */
+    { "system/resources", on_diag_system_resources, MQTT_PRIO_NORMAL },
+};
+
+#define DIAG_TOPIC_PREFIX "chess/diag/"
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+int diagnostics_init(void)
+{
+    char topic[48];
+
+    LOG_INF("Initializing diagnostics module");
+
+    for (size_t i = 0; i < ARRAY_SIZE(diag_routes); i++) {
+        snprintk(topic, sizeof(topic), DIAG_TOPIC_PREFIX "%s", diag_routes[i].command);
+
+        int ret = app_mqtt_subscribe_priority(topic, diag_routes[i].handler,
+                                              diag_routes[i].prio);
+        if (ret < 0) {
+            LOG_ERR("Failed to subscribe to %s: %d", topic, ret);
+            return ret;
+        }
+    }
 
     LOG_INF("Diagnostics module initialized");
     return 0;
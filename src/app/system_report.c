@@ -0,0 +1,147 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/sys_heap.h>
+#include <zephyr/net/net_pkt.h>
+#include <zephyr/net/buf.h>
+#include "system_report.h"
+#include "json_writer.h"
+#include "mqtt_client.h"
+#include "mqtt_ingress.h"
+#include "robot_controller.h"
+
+LOG_MODULE_REGISTER(system_report, LOG_LEVEL_INF);
+
+#define SYSTEM_REPORT_TOPIC    "chess/diag/system/response"
+#define SYSTEM_REPORT_BUF_SIZE 1536
+#define SYSTEM_REPORT_PERIOD_S CONFIG_APP_SYSTEM_REPORT_PERIOD_S
+
+/* The k_malloc() heap; the kernel does not declare it in a public header */
+extern struct k_heap _system_heap;
+
+/* Requested over MQTT and published by the work item, so the buffer is shared */
+static K_MUTEX_DEFINE(report_lock);
+static char report_buf[SYSTEM_REPORT_BUF_SIZE];
+
+static void write_thread(const struct k_thread *thread, void *user_data)
+{
+    json_writer_t *w = user_data;
+    size_t unused = 0;
+    const char *name = k_thread_name_get((k_tid_t)thread);
+
+    jw_object_begin(w);
+    jw_field_string(w, "name", name && name[0] ? name : "?");
+    jw_field_int(w, "prio", thread->base.prio);
+    jw_field_uint(w, "stack", thread->stack_info.size);
+    /* Needs CONFIG_INIT_STACKS: bytes never written since the thread started */
+    if (k_thread_stack_space_get(thread, &unused) == 0) {
+        jw_field_uint(w, "stack_used_max", thread->stack_info.size - unused);
+    }
+    jw_object_end(w);
+}
+
+static void write_slab(json_writer_t *w, const char *key, struct k_mem_slab *slab)
+{
+    jw_field_object_begin(w, key);
+    jw_field_uint(w, "count", slab->info.num_blocks);
+    jw_field_uint(w, "used", k_mem_slab_num_used_get(slab));
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+    jw_field_uint(w, "used_max", k_mem_slab_max_used_get(slab));
+#endif
+    jw_object_end(w);
+}
+
+static void write_buf_pool(json_writer_t *w, const char *key, struct net_buf_pool *pool)
+{
+    jw_field_object_begin(w, key);
+    jw_field_uint(w, "count", pool->buf_count);
+#ifdef CONFIG_NET_BUF_POOL_USAGE
+    jw_field_uint(w, "used", pool->buf_count - atomic_get(&pool->avail_count));
+#endif
+    jw_object_end(w);
+}
+
+static void write_report(json_writer_t *w)
+{
+    struct sys_memory_stats heap;
+    struct k_mem_slab *rx_pkts, *tx_pkts;
+    struct net_buf_pool *rx_bufs, *tx_bufs;
+
+    jw_object_begin(w);
+    jw_field_string(w, "type", "resources");
+    jw_field_uint(w, "timestamp", k_uptime_get_32());
+
+    jw_field_array_begin(w, "threads");
+    k_thread_foreach_unlocked(write_thread, w);
+    jw_array_end(w);
+
+    if (sys_heap_runtime_stats_get(&_system_heap.heap, &heap) == 0) {
+        jw_field_object_begin(w, "heap");
+        jw_field_uint(w, "free", heap.free_bytes);
+        jw_field_uint(w, "allocated", heap.allocated_bytes);
+        jw_field_uint(w, "allocated_max", heap.max_allocated_bytes);
+        jw_object_end(w);
+    }
+
+    net_pkt_get_info(&rx_pkts, &tx_pkts, &rx_bufs, &tx_bufs);
+    jw_field_object_begin(w, "net");
+    write_slab(w, "rx_pkt", rx_pkts);
+    write_slab(w, "tx_pkt", tx_pkts);
+    write_buf_pool(w, "rx_buf", rx_bufs);
+    write_buf_pool(w, "tx_buf", tx_bufs);
+    jw_object_end(w);
+
+    jw_field_uint(w, "mqtt_rx_queued", mqtt_ingress_queued());
+    jw_field_uint(w, "action_queue", robot_controller_queue_depth());
+    jw_field_uint(w, "action_queue_max", ROBOT_ACTION_QUEUE_DEPTH);
+    jw_object_end(w);
+}
+
+int system_report_publish(void)
+{
+    json_writer_t w;
+    int ret;
+
+    k_mutex_lock(&report_lock, K_FOREVER);
+
+    jw_init(&w, report_buf, sizeof(report_buf));
+    write_report(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        LOG_ERR("Resource report does not fit in %d bytes", SYSTEM_REPORT_BUF_SIZE);
+        ret = -ENOMEM;
+    } else {
+        ret = app_mqtt_publish(SYSTEM_REPORT_TOPIC, report_buf, len);
+    }
+
+    k_mutex_unlock(&report_lock);
+    return ret;
+}
+
+static void report_work_fn(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(report_work, report_work_fn);
+
+static void report_work_fn(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    if (app_mqtt_is_connected()) {
+        int ret = system_report_publish();
+        if (ret < 0) {
+            LOG_DBG("Failed to publish resource report (rc=%d)", ret);
+        }
+    }
+
+    k_work_reschedule(&report_work, K_SECONDS(SYSTEM_REPORT_PERIOD_S));
+}
+
+int system_report_init(void)
+{
+    if (SYSTEM_REPORT_PERIOD_S == 0) {
+        return 0;
+    }
+
+    k_work_reschedule(&report_work, K_SECONDS(SYSTEM_REPORT_PERIOD_S));
+    LOG_INF("Resource report every %d s on %s", SYSTEM_REPORT_PERIOD_S, SYSTEM_REPORT_TOPIC);
+    return 0;
+}
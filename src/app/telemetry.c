@@ -0,0 +1,173 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "telemetry.h"
+#include "app_config.h"
+#include "mqtt_client.h"
+#include "robot_controller.h"
+#include "movement_planner.h"
+#include "wire_format.h"
+
+LOG_MODULE_REGISTER(telemetry, LOG_LEVEL_INF);
+
+#if defined(CONFIG_APP_TELEMETRY)
+
+#define TELEMETRY_TOPIC      "chess/robot/telemetry/bin"
+#define TELEMETRY_PERIOD_US  (USEC_PER_SEC / CONFIG_APP_TELEMETRY_RATE_HZ)
+#define TELEMETRY_BATCH_MS   CONFIG_APP_TELEMETRY_BATCH_MS
+#define TELEMETRY_STACK_SIZE 1536
+
+/* Below the robot thread, so sampling never delays step generation */
+#define TELEMETRY_PRIORITY   (THREAD_PRIORITY + 1)
+
+/*
+ * The timer only signals; the thread takes the samples. The semaphore
+ * saturates at one, so ticks missed while the thread was preempted are
+ * skipped instead of bunching up. The timer runs only while the robot
+ * moves; in between the thread sleeps on motion_started.
+ */
+static K_SEM_DEFINE(sample_tick, 0, 1);
+static K_SEM_DEFINE(motion_started, 0, 1);
+
+static void sample_timer_expiry(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+    k_sem_give(&sample_tick);
+}
+
+static K_TIMER_DEFINE(sample_timer, sample_timer_expiry, NULL);
+
+static K_THREAD_STACK_DEFINE(telemetry_stack, TELEMETRY_STACK_SIZE);
+static struct k_thread telemetry_thread;
+
+static struct {
+    uint8_t buf[WIRE_TELEMETRY_HEADER_SIZE +
+                WIRE_TELEMETRY_MAX_SAMPLES * WIRE_TELEMETRY_SAMPLE_SIZE];
+    uint8_t count;
+    uint32_t start_ms;
+    uint32_t seq;
+} batch;
+
+static uint8_t sample_flags(void)
+{
+    uint8_t flags = 0;
+
+    if (robot_controller_is_busy()) {
+        flags |= WIRE_TELEMETRY_FLAG_BUSY;
+    }
+    if (robot_controller_is_xy_moving()) {
+        flags |= WIRE_TELEMETRY_FLAG_XY_MOVING;
+    }
+    if (robot_controller_is_z_moving()) {
+        flags |= WIRE_TELEMETRY_FLAG_Z_MOVING;
+    }
+    if (robot_controller_is_homing()) {
+        flags |= WIRE_TELEMETRY_FLAG_HOMING;
+    }
+
+    return flags;
+}
+
+static void batch_add_sample(uint32_t now)
+{
+    robot_position_t pos = robot_controller_get_position();
+
+    if (batch.count == 0) {
+        batch.start_ms = now;
+    }
+
+    uint8_t *sample = &batch.buf[WIRE_TELEMETRY_HEADER_SIZE +
+                                 batch.count * WIRE_TELEMETRY_SAMPLE_SIZE];
+    wire_encode_telemetry_sample(sample, (uint16_t)(now - batch.start_ms),
+                                 pos.x, pos.y, pos.z, sample_flags(),
+                                 (uint8_t)movement_planner_get_phase());
+    batch.count++;
+}
+
+static void batch_flush(void)
+{
+    if (batch.count == 0) {
+        return;
+    }
+
+    size_t len = wire_encode_telemetry_header(batch.buf, batch.count, batch.start_ms,
+                                              batch.seq++);
+    len += batch.count * WIRE_TELEMETRY_SAMPLE_SIZE;
+    batch.count = 0;
+
+    int rc = app_mqtt_publish(TELEMETRY_TOPIC, (const char *)batch.buf, len);
+    if (rc < 0) {
+        LOG_DBG("Failed to publish telemetry batch (rc=%d)", rc);
+    }
+}
+
+static void motion_start_handler(void)
+{
+    k_sem_give(&motion_started);
+}
+
+static void sample_motion(void)
+{
+    bool was_active = false;
+    bool moving;
+
+    k_sem_reset(&sample_tick);
+    k_timer_start(&sample_timer, K_USEC(TELEMETRY_PERIOD_US), K_USEC(TELEMETRY_PERIOD_US));
+
+    do {
+        k_sem_take(&sample_tick, K_FOREVER);
+
+        moving = robot_controller_is_busy() || robot_controller_is_homing();
+        bool active = app_mqtt_is_connected() && moving;
+
+        /* One more sample after the motion ends records where the gantry stopped */
+        if (!active && !was_active) {
+            continue;
+        }
+        was_active = active;
+
+        uint32_t now = k_uptime_get_32();
+        batch_add_sample(now);
+
+        if (!active || batch.count == WIRE_TELEMETRY_MAX_SAMPLES ||
+            now - batch.start_ms >= TELEMETRY_BATCH_MS) {
+            batch_flush();
+        }
+    } while (moving);
+
+    k_timer_stop(&sample_timer);
+}
+
+static void telemetry_task(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        k_sem_take(&motion_started, K_FOREVER);
+        sample_motion();
+    }
+}
+
+int telemetry_init(void)
+{
+    k_thread_create(&telemetry_thread, telemetry_stack,
+                    K_THREAD_STACK_SIZEOF(telemetry_stack),
+                    telemetry_task, NULL, NULL, NULL,
+                    TELEMETRY_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&telemetry_thread, "telemetry");
+
+    robot_controller_set_motion_start_cb(motion_start_handler);
+
+    LOG_INF("Telemetry at %d Hz on %s", CONFIG_APP_TELEMETRY_RATE_HZ, TELEMETRY_TOPIC);
+    return 0;
+}
+
+#else
+
+int telemetry_init(void)
+{
+    return 0;
+}
+
+#endif /* CONFIG_APP_TELEMETRY */
@@ -0,0 +1,93 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#include "action_trace.h"
+
+static action_latency_t stages[ACTION_STAGE_COUNT];
+static struct k_spinlock stats_lock;
+
+int64_t action_trace_now_us(void)
+{
+    return (int64_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+uint32_t action_trace_mark(const planner_trace_t *trace)
+{
+    int64_t elapsed = action_trace_now_us() - trace->start_us;
+
+    /* 0 means "not reached", so a stage hit in the same tick still counts */
+    return (uint32_t)CLAMP(elapsed, 1, UINT32_MAX);
+}
+
+static int bucket_of(uint32_t us)
+{
+    if (us == 0) {
+        return 0;
+    }
+    return MIN(31 - __builtin_clz(us), ACTION_TRACE_BUCKETS - 1);
+}
+
+/* Called with stats_lock held; skips intervals whose ends were not reached */
+static void add_interval(action_stage_t stage, uint32_t from_us, uint32_t to_us)
+{
+    action_latency_t *h = &stages[stage];
+
+    if (to_us == 0 || to_us < from_us) {
+        return;
+    }
+
+    uint32_t us = to_us - from_us;
+    h->count++;
+    h->sum_us += us;
+    h->max_us = MAX(h->max_us, us);
+    h->buckets[bucket_of(us)]++;
+}
+
+void action_trace_record(const planner_trace_t *trace)
+{
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    if (trace->parsed_us) {
+        add_interval(ACTION_STAGE_INGRESS, 0, trace->parsed_us);
+        add_interval(ACTION_STAGE_SUBMIT, trace->parsed_us, trace->enqueued_us);
+    }
+    add_interval(ACTION_STAGE_QUEUE, trace->enqueued_us, trace->dequeued_us);
+
+    for (int i = 0; i < trace->primitives; i++) {
+        uint32_t end = i + 1 < trace->primitives ? trace->primitive_us[i + 1]
+                                                 : trace->completed_us;
+        add_interval(ACTION_STAGE_PRIMITIVE, trace->primitive_us[i], end);
+    }
+
+    add_interval(ACTION_STAGE_EXECUTE, trace->dequeued_us, trace->completed_us);
+    add_interval(ACTION_STAGE_TOTAL, 0, trace->completed_us);
+
+    k_spin_unlock(&stats_lock, key);
+}
+
+void action_trace_get(action_stage_t stage, action_latency_t *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    *out = stages[stage];
+    k_spin_unlock(&stats_lock, key);
+}
+
+void action_trace_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    memset(stages, 0, sizeof(stages));
+    k_spin_unlock(&stats_lock, key);
+}
+
+const char *action_stage_name(action_stage_t stage)
+{
+    switch (stage) {
+    case ACTION_STAGE_INGRESS:   return "ingress";
+    case ACTION_STAGE_SUBMIT:    return "submit";
+    case ACTION_STAGE_QUEUE:     return "queue";
+    case ACTION_STAGE_PRIMITIVE: return "primitive";
+    case ACTION_STAGE_EXECUTE:   return "execute";
+    case ACTION_STAGE_TOTAL:     return "total";
+    default:                     return "unknown";
+    }
+}
@@ -0,0 +1,96 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include "board_history.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(BOARD_HISTORY_SIZE), "BOARD_HISTORY_SIZE must be a power of two");
+
+/*
+ * Each slot carries a generation word (seq + 1, 0 while being written) so
+ * readers can detect a slot that was overwritten under them without taking
+ * a lock. Zephyr atomics are full barriers, which orders the frame copy
+ * against the generation checks on both sides.
+ */
+typedef struct {
+    atomic_t gen;
+    board_frame_t frame;
+} history_slot_t;
+
+static history_slot_t ring[BOARD_HISTORY_SIZE];
+static atomic_t head = ATOMIC_INIT(0);
+
+uint64_t board_history_now_cycles(void)
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+    return k_cycle_get_64();
+#else
+    /*
+     * Extend the 32-bit cycle counter using the 64-bit tick count as the
+     * coarse part. Both come from the same timer, so the estimate is within
+     * a tick of the real value and picks the right wrap period.
+     */
+    uint64_t estimate = k_ticks_to_cyc_floor64(k_uptime_ticks());
+    uint64_t cycles = (estimate & ~(uint64_t)UINT32_MAX) | k_cycle_get_32();
+
+    if ((int64_t)(cycles - estimate) > INT32_MAX) {
+        cycles -= 1ULL << 32;
+    } else if ((int64_t)(estimate - cycles) > INT32_MAX) {
+        cycles += 1ULL << 32;
+    }
+    return cycles;
+#endif
+}
+
+uint64_t board_history_cycles_to_us(uint64_t cycles)
+{
+    return k_cyc_to_us_floor64(cycles);
+}
+
+void board_history_record(board_frame_kind_t kind, uint64_t mask)
+{
+    uint32_t seq = (uint32_t)atomic_get(&head);
+    history_slot_t *slot = &ring[seq & (BOARD_HISTORY_SIZE - 1)];
+
+    atomic_set(&slot->gen, 0);
+    slot->frame.cycles = board_history_now_cycles();
+    slot->frame.mask = mask;
+    slot->frame.seq = seq;
+    slot->frame.kind = (uint8_t)kind;
+    atomic_set(&slot->gen, (atomic_val_t)(seq + 1));
+
+    atomic_set(&head, (atomic_val_t)(seq + 1));
+}
+
+uint32_t board_history_head(void)
+{
+    return (uint32_t)atomic_get(&head);
+}
+
+uint32_t board_history_oldest(void)
+{
+    uint32_t next = board_history_head();
+    return next > BOARD_HISTORY_SIZE ? next - BOARD_HISTORY_SIZE : 0;
+}
+
+int board_history_read(uint32_t seq, board_frame_t *frame)
+{
+    const history_slot_t *slot = &ring[seq & (BOARD_HISTORY_SIZE - 1)];
+    atomic_val_t expected = (atomic_val_t)(seq + 1);
+
+    if (!frame) {
+        return -EINVAL;
+    }
+
+    if (atomic_get(&slot->gen) != expected) {
+        return -ENOENT;
+    }
+
+    *frame = slot->frame;
+
+    if (atomic_get(&slot->gen) != expected) {
+        return -ENOENT;
+    }
+
+    return 0;
+}
@@ -6,9 +6,111 @@
 
 LOG_MODULE_REGISTER(board_manager, LOG_LEVEL_INF);
 
+/* Consecutive identical scans required before a frame is accepted */
+#define BOARD_DEBOUNCE_SCANS 2
+
+/* Default activity-driven scan schedule */
+#define BOARD_SCAN_IDLE_INTERVAL_MS   250
+#define BOARD_SCAN_ACTIVE_INTERVAL_MS 20
+#define BOARD_SCAN_DECAY_MS           3000
+
+/*
+ * Sensor health: a square that toggles BOARD_FLAP_THRESHOLD times within
+ * BOARD_FLAP_WINDOW_MS is masked until it stays quiet for
+ * BOARD_FLAP_RECOVERY_WINDOWS full windows.
+ */
+#define BOARD_FLAP_WINDOW_MS        10000
+#define BOARD_FLAP_THRESHOLD        8
+#define BOARD_FLAP_RECOVERY_WINDOWS 3
+#define BOARD_HEALTH_REPORT_MS      30000
+#define BOARD_STUCK_TICK_MS         100
+
+/* Bit planes per counter; bit i of every square's count lives in plane i */
+#define HEALTH_TRANSITION_BITS 16
+#define HEALTH_WINDOW_BITS     4
+#define HEALTH_QUIET_BITS      2
+#define HEALTH_STUCK_BITS      16
+
+BUILD_ASSERT(BOARD_FLAP_THRESHOLD < (1 << HEALTH_WINDOW_BITS), "flap threshold exceeds window counter");
+BUILD_ASSERT(BOARD_FLAP_RECOVERY_WINDOWS < (1 << HEALTH_QUIET_BITS), "recovery windows exceed quiet counter");
+
+/* Robot actions that can run back to back before a settling scan (queue depth + running action) */
+#define ROBOT_GATE_MAX_ACTIONS 8
+
+typedef struct {
+    planner_action_t action;
+    planner_result_t result;
+    uint64_t squares;
+    uint64_t set_mask;
+    uint64_t clear_mask;
+    uint32_t seq;
+} robot_gate_entry_t;
+
+/*
+ * Squares touched by planner actions that have not been verified yet.
+ * Written from the robot thread (phase callback), consumed by the scanning thread.
+ * Entries are numbered in start order, so the scanner can tell which of the
+ * entries it snapshotted are still there after an overflow dropped some.
+ */
+static struct {
+    robot_gate_entry_t entries[ROBOT_GATE_MAX_ACTIONS];
+    uint8_t count;
+    bool running;
+    uint64_t squares;
+    uint32_t next_seq;
+} robot_gate;
+static struct k_spinlock robot_gate_lock;
+
+/* Debounce state and scan sequence numbers, shared with board_manager_wait_fresh_scan() */
+static uint64_t raw_mask;
+static uint8_t raw_stable_scans;
+static uint64_t debounced_mask;
+static uint32_t scan_started_seq;
+static uint32_t debounced_seq;
+static atomic_t scan_waiters = ATOMIC_INIT(0);
+static K_MUTEX_DEFINE(scan_lock);
+static K_CONDVAR_DEFINE(scan_done);
+static K_SEM_DEFINE(scan_request, 0, 1);
+
+/* Scan scheduler: config is written from the MQTT thread, activity from the scanner */
+static board_scan_config_t scan_config = {
+    .idle_interval_ms = BOARD_SCAN_IDLE_INTERVAL_MS,
+    .active_interval_ms = BOARD_SCAN_ACTIVE_INTERVAL_MS,
+    .decay_ms = BOARD_SCAN_DECAY_MS,
+};
+static struct k_spinlock scan_config_lock;
+static uint32_t last_activity_time;
+static volatile bool human_turn;
+
+/*
+ * Bit-sliced per-square counters. All 64 squares are counted in parallel
+ * with a handful of word operations per plane, so the update is cheap
+ * enough to run on every raw scan. Owned by the scanning thread.
+ */
+static struct {
+    uint64_t transitions[HEALTH_TRANSITION_BITS];
+    uint64_t window[HEALTH_WINDOW_BITS];
+    uint64_t quiet[HEALTH_QUIET_BITS];
+    uint64_t stuck[HEALTH_STUCK_BITS];
+    uint64_t masked;
+    uint32_t frames;
+    uint32_t window_start;
+    uint32_t last_tick;
+    uint32_t last_report;
+} health;
+
+/* Pending history replay, handed from the MQTT thread to the scanner */
+enum { REPLAY_IDLE, REPLAY_FILLING, REPLAY_READY };
+static board_replay_request_t replay_request;
+static atomic_t replay_pending = ATOMIC_INIT(REPLAY_IDLE);
+static bool replay_report_moves;
+
 static chess_board_state_t board_state;
 static board_move_callback_t move_callback = NULL;
 static board_state_callback_t state_callback = NULL;
+static board_robot_move_callback_t robot_move_callback = NULL;
+static board_replay_callback_t replay_callback = NULL;
+static board_health_callback_t health_callback = NULL;
 
 static void log_board_mask(uint64_t mask)
 {
@@ -24,6 +126,88 @@ static void log_board_mask(uint64_t mask)
     }
 }
 
+/*
+ * Fill in which matrix bits an action empties and fills.
+ * Returns the union of both, i.e. every square the gripper works on.
+ */
+static uint64_t action_squares(const planner_action_t *action,
+                               uint64_t *set_mask, uint64_t *clear_mask)
+{
+    uint64_t from = square_bit(action->from.file, action->from.rank);
+    uint64_t to = square_bit(action->to.file, action->to.rank);
+
+    *set_mask = 0;
+    *clear_mask = 0;
+
+    switch (action->type) {
+    case PLANNER_ACTION_MOVE:
+    case PLANNER_ACTION_CAPTURE:
+        *clear_mask = from;
+        *set_mask = to;
+        break;
+    case PLANNER_ACTION_EN_PASSANT:
+        *clear_mask = from | square_bit(action->captured.file, action->captured.rank);
+        *set_mask = to;
+        break;
+    case PLANNER_ACTION_CASTLE:
+        *clear_mask = from | square_bit(action->from2.file, action->from2.rank);
+        *set_mask = to | square_bit(action->to2.file, action->to2.rank);
+        break;
+    case PLANNER_ACTION_REMOVE:
+        *clear_mask = from;
+        break;
+    default:
+        break;
+    }
+
+    /* A square that is both emptied and refilled ends up occupied */
+    *clear_mask &= ~*set_mask;
+
+    return *set_mask | *clear_mask;
+}
+
+static void on_planner_phase(const planner_phase_event_t *event)
+{
+    k_spinlock_key_t key;
+
+    switch (event->phase) {
+    case PLANNER_PHASE_ACTION_BEGIN: {
+        key = k_spin_lock(&robot_gate_lock);
+        if (robot_gate.count == ROBOT_GATE_MAX_ACTIONS) {
+            /* Scanner fell behind: drop the oldest entry but keep its squares gated */
+            memmove(&robot_gate.entries[0], &robot_gate.entries[1],
+                    sizeof(robot_gate.entries[0]) * (ROBOT_GATE_MAX_ACTIONS - 1));
+            robot_gate.count--;
+        }
+        robot_gate_entry_t *entry = &robot_gate.entries[robot_gate.count++];
+        entry->action = *event->action;
+        entry->result = PLANNER_ERR_BUSY;
+        entry->seq = robot_gate.next_seq++;
+        entry->squares = action_squares(event->action, &entry->set_mask, &entry->clear_mask);
+        robot_gate.squares |= entry->squares;
+        robot_gate.running = true;
+        k_spin_unlock(&robot_gate_lock, key);
+
+        /* Robot's turn: switch to the fast rate so the action settles quickly */
+        human_turn = false;
+        k_sem_give(&scan_request);
+        break;
+    }
+
+    case PLANNER_PHASE_ACTION_END:
+        key = k_spin_lock(&robot_gate_lock);
+        if (robot_gate.count > 0) {
+            robot_gate.entries[robot_gate.count - 1].result = event->result;
+        }
+        robot_gate.running = false;
+        k_spin_unlock(&robot_gate_lock, key);
+        break;
+
+    default:
+        break;
+    }
+}
+
 int board_manager_init(void)
 {
     int ret;
@@ -45,22 +229,49 @@ int board_manager_init(void)
     board_state.previous_mask = board_state.occupied_mask;
     board_state.last_update_time = k_uptime_get_32();
 
+    raw_mask = board_state.occupied_mask;
+    raw_stable_scans = BOARD_DEBOUNCE_SCANS;
+    debounced_mask = board_state.occupied_mask;
+
+    board_history_record(BOARD_FRAME_RAW, raw_mask);
+    board_history_record(BOARD_FRAME_DEBOUNCED, debounced_mask);
+
+    last_activity_time = k_uptime_get_32();
+
+    memset(&health, 0, sizeof(health));
+    health.window_start = k_uptime_get_32();
+    health.last_tick = health.window_start;
+    health.last_report = health.window_start;
+
+    movement_planner_register_phase_callback(on_planner_phase);
+    movement_planner_register_occupancy_probe(board_manager_wait_fresh_scan);
+
     LOG_INF("Board manager initialized");
     return 0;
 }
 
-static void detect_and_report_move(uint64_t old_mask, uint64_t new_mask)
+/*
+ * Infer a move from two successive frames. Returns true if a single move
+ * was found. Replayed frames (BOARD_MOVE_FLAG_REPLAY) leave the live game
+ * state alone.
+ */
+static bool detect_and_report_move(uint64_t old_mask, uint64_t new_mask,
+                                   uint64_t timestamp_us, uint8_t flags)
 {
+    bool replay = (flags & BOARD_MOVE_FLAG_REPLAY) != 0;
     uint64_t changed = old_mask ^ new_mask;
     uint64_t removed = old_mask & changed;
     uint64_t added = new_mask & changed;
 
     int removed_count = __builtin_popcountll(removed);
     int added_count = __builtin_popcountll(added);
+    bool human_move = true;
 
     if (removed_count == 1 && added_count == 1) {
         board_move_t move;
         move.timestamp = k_uptime_get_32();
+        move.timestamp_us = timestamp_us;
+        move.flags = flags;
 
         for (int i = 0; i < 64; i++) {
             if (removed & (1ULL << i)) {
@@ -73,22 +284,308 @@ static void detect_and_report_move(uint64_t old_mask, uint64_t new_mask)
             }
         }
 
-        LOG_INF("Move detected: (%d,%d) -> (%d,%d)",
+        LOG_INF("%s detected: (%d,%d) -> (%d,%d)",
+                replay ? "Replayed move" : "Move",
                 move.from.row, move.from.col,
                 move.to.row, move.to.col);
 
-        if (move_callback) {
+        if (move_callback && (!replay || replay_report_moves)) {
             move_callback(&move);
         }
 
-        board_state.move_count++;
+        if (!replay) {
+            board_state.move_count++;
+            human_turn = false;
+        }
+        return true;
     } else if (removed_count == 2 && added_count == 2) {
         LOG_INF("Castling detected");
     } else if (removed_count == 2 && added_count == 1) {
+        /* Also en passant: mover and captured pawn leave, one square fills */
         LOG_INF("Capture detected");
-    } else if (changed != 0) {
-        LOG_DBG("Complex board change detected (removed: %d, added: %d)",
-                removed_count, added_count);
+    } else {
+        human_move = false;
+        if (changed != 0) {
+            LOG_DBG("Complex board change detected (removed: %d, added: %d)",
+                    removed_count, added_count);
+        }
+    }
+
+    if (human_move && !replay) {
+        human_turn = false;
+    }
+
+    return false;
+}
+
+/* Add one to the counters of every square in @p inc, saturating at all-ones */
+static void slice_increment(uint64_t *planes, int bits, uint64_t inc)
+{
+    uint64_t carry = inc;
+
+    for (int i = 0; i < bits && carry; i++) {
+        uint64_t next = planes[i] & carry;
+        planes[i] ^= carry;
+        carry = next;
+    }
+
+    /* Overflowed squares wrapped to zero: pin them at the maximum instead */
+    for (int i = 0; i < bits && carry; i++) {
+        planes[i] |= carry;
+    }
+}
+
+static void slice_clear(uint64_t *planes, int bits, uint64_t squares)
+{
+    for (int i = 0; i < bits; i++) {
+        planes[i] &= ~squares;
+    }
+}
+
+/* Squares whose counter is >= @p value */
+static uint64_t slice_ge(const uint64_t *planes, int bits, uint32_t value)
+{
+    uint64_t gt = 0;
+    uint64_t eq = ~0ULL;
+
+    for (int i = bits - 1; i >= 0; i--) {
+        uint64_t ref = (value & (1U << i)) ? ~0ULL : 0;
+        gt |= eq & planes[i] & ~ref;
+        eq &= ~(planes[i] ^ ref);
+    }
+
+    return gt | eq;
+}
+
+static uint32_t slice_get(const uint64_t *planes, int bits, int square)
+{
+    uint32_t value = 0;
+
+    for (int i = 0; i < bits; i++) {
+        value |= (uint32_t)((planes[i] >> square) & 1U) << i;
+    }
+
+    return value;
+}
+
+/*
+ * Account one raw scan. @p changed holds the squares that differ from the
+ * previous scan; squares the robot is working on are expected to toggle
+ * and do not count towards flapping.
+ */
+static void sensor_health_update(uint64_t changed, uint64_t gated)
+{
+    uint32_t now = k_uptime_get_32();
+    uint64_t counted = changed & ~gated;
+
+    health.frames++;
+    slice_increment(health.transitions, HEALTH_TRANSITION_BITS, counted);
+    slice_increment(health.window, HEALTH_WINDOW_BITS, counted);
+
+    /* Stuck time advances in BOARD_STUCK_TICK_MS units, independent of the scan rate */
+    while ((now - health.last_tick) >= BOARD_STUCK_TICK_MS) {
+        slice_increment(health.stuck, HEALTH_STUCK_BITS, ~0ULL);
+        health.last_tick += BOARD_STUCK_TICK_MS;
+    }
+    slice_clear(health.stuck, HEALTH_STUCK_BITS, changed);
+
+    uint64_t flapping = slice_ge(health.window, HEALTH_WINDOW_BITS, BOARD_FLAP_THRESHOLD);
+    uint64_t newly_masked = flapping & ~health.masked;
+    if (newly_masked) {
+        health.masked |= newly_masked;
+        slice_clear(health.quiet, HEALTH_QUIET_BITS, newly_masked);
+        LOG_WRN("Masking flapping squares 0x%016llx", newly_masked);
+    }
+
+    if ((now - health.window_start) >= BOARD_FLAP_WINDOW_MS) {
+        /* Masked squares that stayed silent for the whole window earn a quiet point */
+        uint64_t active = slice_ge(health.window, HEALTH_WINDOW_BITS, 1);
+        slice_clear(health.quiet, HEALTH_QUIET_BITS, active);
+        slice_increment(health.quiet, HEALTH_QUIET_BITS, health.masked & ~active);
+
+        uint64_t recovered = health.masked &
+                             slice_ge(health.quiet, HEALTH_QUIET_BITS, BOARD_FLAP_RECOVERY_WINDOWS);
+        if (recovered) {
+            health.masked &= ~recovered;
+            LOG_INF("Unmasking recovered squares 0x%016llx", recovered);
+        }
+
+        slice_clear(health.window, HEALTH_WINDOW_BITS, ~0ULL);
+        health.window_start = now;
+    }
+
+    if (health_callback && (now - health.last_report) >= BOARD_HEALTH_REPORT_MS) {
+        board_health_t report;
+        board_manager_get_health(&report);
+        health.last_report = now;
+        health_callback(&report);
+    }
+}
+
+/*
+ * Feed recorded frames back through detect_and_report_move() and time each
+ * call. Runs on the scanning thread so it never races live detection.
+ */
+static void run_replay(const board_replay_request_t *request)
+{
+    board_replay_result_t result = {
+        .request = *request,
+        .min_cycles = UINT32_MAX,
+    };
+    uint64_t prev_mask = 0;
+    bool have_prev = false;
+
+    replay_report_moves = request->report_moves;
+
+    for (uint32_t seq = board_history_oldest(); seq != board_history_head(); seq++) {
+        board_frame_t frame;
+
+        if (board_history_read(seq, &frame) < 0) {
+            result.missing++;
+            continue;
+        }
+        if (frame.kind != request->source) {
+            continue;
+        }
+
+        uint64_t t_us = board_history_cycles_to_us(frame.cycles);
+        if (t_us < request->from_us) {
+            /* Last frame before the window is the baseline */
+            prev_mask = frame.mask;
+            have_prev = true;
+            continue;
+        }
+        if (t_us > request->to_us) {
+            break;
+        }
+
+        if (have_prev) {
+            uint32_t start = k_cycle_get_32();
+            bool moved = detect_and_report_move(prev_mask, frame.mask, t_us,
+                                                BOARD_MOVE_FLAG_REPLAY);
+            uint32_t cycles = k_cycle_get_32() - start;
+
+            result.frames++;
+            result.moves += moved ? 1 : 0;
+            result.total_cycles += cycles;
+            result.min_cycles = MIN(result.min_cycles, cycles);
+            result.max_cycles = MAX(result.max_cycles, cycles);
+        }
+
+        prev_mask = frame.mask;
+        have_prev = true;
+    }
+
+    if (result.frames == 0) {
+        result.min_cycles = 0;
+    }
+
+    LOG_INF("Replay done: %u frames, %u moves, %u missing",
+            result.frames, result.moves, result.missing);
+
+    if (replay_callback) {
+        replay_callback(&result);
+    }
+}
+
+static void commit_state(uint64_t new_mask)
+{
+    board_state.previous_mask = board_state.occupied_mask;
+    board_state.occupied_mask = new_mask;
+    board_state.last_update_time = k_uptime_get_32();
+
+    LOG_DBG("Board state changed. New mask:");
+    log_board_mask(new_mask);
+
+    if (state_callback) {
+        state_callback(&board_state);
+    }
+}
+
+/*
+ * Verify the gated actions numbered below @p end_seq against a scan that
+ * started after all of them ended, report one robot move per action and
+ * publish the resulting state once. Entries an overflow dropped since the
+ * snapshot are gone from the front of the gate and are simply not counted.
+ */
+static void settle_robot_actions(uint32_t end_seq, uint64_t scan_mask)
+{
+    robot_gate_entry_t done[ROBOT_GATE_MAX_ACTIONS];
+    uint64_t done_squares = 0;
+    uint64_t still_gated = 0;
+    uint8_t count = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&robot_gate_lock);
+    while (count < robot_gate.count &&
+           (int32_t)(robot_gate.entries[count].seq - end_seq) < 0) {
+        count++;
+    }
+    memcpy(done, robot_gate.entries, sizeof(done[0]) * count);
+    robot_gate.count -= count;
+    memmove(&robot_gate.entries[0], &robot_gate.entries[count],
+            sizeof(robot_gate.entries[0]) * robot_gate.count);
+    for (int i = 0; i < robot_gate.count; i++) {
+        still_gated |= robot_gate.entries[i].squares;
+    }
+    robot_gate.squares = still_gated;
+    k_spin_unlock(&robot_gate_lock, key);
+
+    /* Replay the actions over the pre-action occupancy (frozen on gated squares) */
+    uint64_t expected = board_state.occupied_mask;
+    uint64_t expected_after[ROBOT_GATE_MAX_ACTIONS];
+    for (int i = 0; i < count; i++) {
+        expected = (expected & ~done[i].clear_mask) | done[i].set_mask;
+        expected_after[i] = expected;
+        done_squares |= done[i].squares;
+    }
+
+    for (int i = 0; i < count; i++) {
+        /*
+         * Squares reworked by a later action can only be checked against
+         * that one; squares an action still running is touching are not
+         * stable yet.
+         */
+        uint64_t later = still_gated;
+        for (int j = i + 1; j < count; j++) {
+            later |= done[j].squares;
+        }
+        uint64_t own = done[i].squares & ~later;
+
+        board_robot_move_t robot_move = {
+            .action = done[i].action,
+            .result = done[i].result,
+            .squares = done[i].squares,
+            .expected_mask = expected_after[i] & done[i].squares,
+            .observed_mask = scan_mask & done[i].squares,
+            .verified = done[i].result == PLANNER_OK &&
+                        ((scan_mask ^ expected) & own) == 0,
+            .timestamp = k_uptime_get_32(),
+        };
+
+        if (robot_move.verified) {
+            board_state.move_count++;
+            LOG_INF("Robot move verified (squares 0x%016llx)", robot_move.squares);
+        } else {
+            LOG_WRN("Robot move not verified: result=%d expected=0x%016llx observed=0x%016llx",
+                    robot_move.result, robot_move.expected_mask, robot_move.observed_mask);
+        }
+
+        if (robot_move_callback) {
+            robot_move_callback(&robot_move);
+        }
+    }
+
+    /* Squares a newer action already works on keep their expected value until it settles */
+    uint64_t committed = (scan_mask & ~still_gated) |
+                         (expected & still_gated & done_squares) |
+                         (board_state.occupied_mask & still_gated & ~done_squares);
+
+    if (committed != board_state.occupied_mask) {
+        commit_state(committed);
+    }
+
+    if (still_gated == 0) {
+        board_manager_set_human_turn(true);
     }
 }
 
@@ -97,30 +594,215 @@ int board_manager_update(void)
     int ret;
     uint64_t new_mask;
 
+    if (atomic_get(&replay_pending) == REPLAY_READY) {
+        run_replay(&replay_request);
+        atomic_set(&replay_pending, REPLAY_IDLE);
+    }
+
+    /*
+     * Snapshot the robot gate before scanning: actions that had already
+     * ended at this point are settled by this scan, anything that starts
+     * while the scan is running stays gated.
+     */
+    k_spinlock_key_t key = k_spin_lock(&robot_gate_lock);
+    uint64_t gated = robot_gate.squares;
+    uint8_t settled = robot_gate.running ? robot_gate.count - 1 : robot_gate.count;
+    uint32_t settled_end = settled > 0 ? robot_gate.entries[settled - 1].seq + 1 : 0;
+    k_spin_unlock(&robot_gate_lock, key);
+
+    k_mutex_lock(&scan_lock, K_FOREVER);
+    uint32_t seq = ++scan_started_seq;
+    k_mutex_unlock(&scan_lock);
+
     ret = board_driver_scan(&new_mask);
     if (ret < 0) {
         LOG_ERR("Board scan failed: %d", ret);
         return ret;
     }
 
-    if (new_mask != board_state.occupied_mask) {
-        detect_and_report_move(board_state.occupied_mask, new_mask);
+    sensor_health_update(raw_mask ^ new_mask, gated);
+
+    /* Only frames seen on BOARD_DEBOUNCE_SCANS consecutive scans are acted upon */
+    if (new_mask == raw_mask) {
+        if (raw_stable_scans < BOARD_DEBOUNCE_SCANS) {
+            raw_stable_scans++;
+        }
+    } else {
+        raw_mask = new_mask;
+        raw_stable_scans = 1;
+        last_activity_time = k_uptime_get_32();
+        board_history_record(BOARD_FRAME_RAW, new_mask);
+    }
+
+    if (raw_stable_scans < BOARD_DEBOUNCE_SCANS) {
+        return 0;
+    }
+
+    if (new_mask != debounced_mask) {
+        board_history_record(BOARD_FRAME_DEBOUNCED, new_mask);
+    }
+
+    k_mutex_lock(&scan_lock, K_FOREVER);
+    debounced_mask = new_mask;
+    debounced_seq = seq;
+    k_condvar_broadcast(&scan_done);
+    k_mutex_unlock(&scan_lock);
+
+    /* Masked (flapping) squares keep their last trusted value */
+    uint64_t trusted = (new_mask & ~health.masked) | (board_state.occupied_mask & health.masked);
+
+    /* Changes on squares the robot is working on are withheld until it settles */
+    uint64_t visible = (trusted & ~gated) | (board_state.occupied_mask & gated);
+
+    if (visible != board_state.occupied_mask) {
+        detect_and_report_move(board_state.occupied_mask, visible,
+                               board_history_cycles_to_us(board_history_now_cycles()), 0);
+        commit_state(visible);
+    }
+
+    if (settled > 0) {
+        settle_robot_actions(settled_end, trusted);
+    }
 
-        board_state.previous_mask = board_state.occupied_mask;
-        board_state.occupied_mask = new_mask;
-        board_state.last_update_time = k_uptime_get_32();
+    return 0;
+}
 
-        LOG_DBG("Board state changed. New mask:");
-        log_board_mask(new_mask);
+int board_manager_wait_fresh_scan(uint64_t *mask, k_timeout_t timeout)
+{
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+    int ret = 0;
+
+    if (!mask) {
+        return -EINVAL;
+    }
 
-        if (state_callback) {
-            state_callback(&board_state);
+    atomic_inc(&scan_waiters);
+    k_sem_give(&scan_request);
+
+    k_mutex_lock(&scan_lock, K_FOREVER);
+    /* A scan already running may predate the caller's last motion: wait for the next one */
+    uint32_t after = scan_started_seq;
+    while ((int32_t)(debounced_seq - after) <= 0) {
+        if (k_condvar_wait(&scan_done, &scan_lock, sys_timepoint_timeout(end)) != 0) {
+            ret = -ETIMEDOUT;
+            break;
         }
     }
+    if (ret == 0) {
+        *mask = debounced_mask;
+    }
+    k_mutex_unlock(&scan_lock);
 
+    atomic_dec(&scan_waiters);
+    return ret;
+}
+
+uint32_t board_manager_get_scan_interval_ms(void)
+{
+    board_scan_config_t config;
+    board_manager_get_scan_config(&config);
+
+    k_spinlock_key_t key = k_spin_lock(&robot_gate_lock);
+    uint8_t gated_actions = robot_gate.count;
+    k_spin_unlock(&robot_gate_lock, key);
+
+    /* A human turn counts as activity when it starts, then decays like any other */
+    bool active = gated_actions > 0 ||
+                  raw_stable_scans < BOARD_DEBOUNCE_SCANS ||
+                  (k_uptime_get_32() - last_activity_time) < config.decay_ms;
+
+    return active ? config.active_interval_ms : config.idle_interval_ms;
+}
+
+void board_manager_wait_next_scan(void)
+{
+    /* Keep scanning back to back while the planner waits for a fresh frame */
+    if (atomic_get(&scan_waiters) > 0) {
+        return;
+    }
+
+    (void)k_sem_take(&scan_request, K_MSEC(board_manager_get_scan_interval_ms()));
+}
+
+void board_manager_get_scan_config(board_scan_config_t *config)
+{
+    k_spinlock_key_t key = k_spin_lock(&scan_config_lock);
+    *config = scan_config;
+    k_spin_unlock(&scan_config_lock, key);
+}
+
+int board_manager_set_scan_config(const board_scan_config_t *config)
+{
+    if (!config ||
+        config->active_interval_ms < BOARD_SCAN_INTERVAL_MIN_MS ||
+        config->idle_interval_ms > BOARD_SCAN_INTERVAL_MAX_MS ||
+        config->active_interval_ms > config->idle_interval_ms ||
+        config->decay_ms > BOARD_SCAN_DECAY_MAX_MS) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&scan_config_lock);
+    scan_config = *config;
+    k_spin_unlock(&scan_config_lock, key);
+
+    LOG_INF("Scan schedule: idle=%ums active=%ums decay=%ums",
+            config->idle_interval_ms, config->active_interval_ms, config->decay_ms);
+
+    k_sem_give(&scan_request);
     return 0;
 }
 
+void board_manager_set_human_turn(bool turn)
+{
+    human_turn = turn;
+    if (turn) {
+        last_activity_time = k_uptime_get_32();
+        k_sem_give(&scan_request);
+    }
+}
+
+bool board_manager_is_human_turn(void)
+{
+    return human_turn;
+}
+
+int board_manager_request_replay(const board_replay_request_t *request)
+{
+    if (!request || request->to_us < request->from_us ||
+        (request->source != BOARD_FRAME_RAW && request->source != BOARD_FRAME_DEBOUNCED)) {
+        return -EINVAL;
+    }
+
+    /* Only returns to idle once the scanner has consumed the previous request */
+    if (!atomic_cas(&replay_pending, REPLAY_IDLE, REPLAY_FILLING)) {
+        return -EBUSY;
+    }
+
+    replay_request = *request;
+    atomic_set(&replay_pending, REPLAY_READY);
+    k_sem_give(&scan_request);
+    return 0;
+}
+
+void board_manager_get_health(board_health_t *out)
+{
+    if (!out) {
+        return;
+    }
+
+    out->masked = health.masked;
+    out->flapping = slice_ge(health.window, HEALTH_WINDOW_BITS, BOARD_FLAP_THRESHOLD);
+    out->frames = health.frames;
+    out->window_ms = BOARD_FLAP_WINDOW_MS;
+    out->timestamp = k_uptime_get_32();
+
+    for (int sq = 0; sq < CHESS_BOARD_SIZE * CHESS_BOARD_SIZE; sq++) {
+        out->transitions[sq] = (uint16_t)slice_get(health.transitions, HEALTH_TRANSITION_BITS, sq);
+        out->window_transitions[sq] = (uint8_t)slice_get(health.window, HEALTH_WINDOW_BITS, sq);
+        out->stuck_ms[sq] = slice_get(health.stuck, HEALTH_STUCK_BITS, sq) * BOARD_STUCK_TICK_MS;
+    }
+}
+
 const chess_board_state_t *board_manager_get_state(void)
 {
     return &board_state;
@@ -135,3 +817,18 @@ void board_manager_register_state_callback(board_state_callback_t callback)
 {
     state_callback = callback;
 }
+
+void board_manager_register_robot_move_callback(board_robot_move_callback_t callback)
+{
+    robot_move_callback = callback;
+}
+
+void board_manager_register_replay_callback(board_replay_callback_t callback)
+{
+    replay_callback = callback;
+}
+
+void board_manager_register_health_callback(board_health_callback_t callback)
+{
+    health_callback = callback;
+}
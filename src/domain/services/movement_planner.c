@@ -5,9 +5,35 @@
 #include "robot_controller.h"
 #include "stepper_manager.h"
 #include "robot_config.h"
+#include "board_state.h"
+#include "action_trace.h"
 
 LOG_MODULE_REGISTER(movement_planner, LOG_LEVEL_INF);
 
+/** Offset applied to a grip attempt, relative to the square centre and pick/place height. */
+typedef struct {
+    int32_t dx;
+    int32_t dy;
+    int32_t dz;
+} grip_offset_t;
+
+/* Attempt 0 is the nominal grip; retries walk around the centre and press deeper */
+static const grip_offset_t grip_offsets[] = {
+    {  0,                                 0,                                 0 },
+    {  ROBOT_CONFIG_GRIP_RETRY_XY_STEPS,  0,                                 ROBOT_CONFIG_GRIP_RETRY_Z_STEPS },
+    { -ROBOT_CONFIG_GRIP_RETRY_XY_STEPS,  0,                                 ROBOT_CONFIG_GRIP_RETRY_Z_STEPS },
+    {  0,                                 ROBOT_CONFIG_GRIP_RETRY_XY_STEPS,  ROBOT_CONFIG_GRIP_RETRY_Z_STEPS },
+    {  0,                                -ROBOT_CONFIG_GRIP_RETRY_XY_STEPS,  ROBOT_CONFIG_GRIP_RETRY_Z_STEPS },
+};
+
+BUILD_ASSERT(ROBOT_CONFIG_GRIP_RETRIES < ARRAY_SIZE(grip_offsets),
+             "Not enough grip offsets for the configured retries");
+
+static planner_phase_callback_t phase_callback = NULL;
+static planner_occupancy_probe_t occupancy_probe = NULL;
+static volatile planner_phase_t current_phase = PLANNER_PHASE_IDLE;
+static planner_action_t *current_action = NULL;
+
 static inline int32_t file_to_x(uint8_t file)
 {
     return ROBOT_CONFIG_BOARD_ORIGIN_X + (int32_t)file * ROBOT_CONFIG_STEPS_PER_SQUARE;
@@ -41,12 +67,39 @@ static void wait_z(void)
     }
 }
 
+/**
+ * Record the new phase and notify the registered observer.
+ */
+static void emit_phase(planner_phase_t phase, chess_square_t sq, bool on_board,
+                       planner_result_t result)
+{
+    current_phase = phase;
+
+    if (current_action && (phase == PLANNER_PHASE_PICKUP || phase == PLANNER_PHASE_PLACE)) {
+        planner_trace_t *trace = &current_action->trace;
+        if (trace->primitives < PLANNER_TRACE_PRIMITIVES) {
+            trace->primitive_us[trace->primitives++] = action_trace_mark(trace);
+        }
+    }
+
+    if (phase_callback) {
+        planner_phase_event_t event = {
+            .phase    = phase,
+            .action   = current_action,
+            .square   = sq,
+            .on_board = on_board,
+            .result   = result,
+        };
+        phase_callback(&event);
+    }
+}
+
 /* ============================================================================
  * Primitive motion sequences
  * ============================================================================ */
 
 /**
- * @brief Pick up the piece centred on @p sq.
+ * @brief Pick up the piece centred on @p sq, shifted by @p offset.
  *
  * Sequence:
  *   1. Move XY to the square (concurrent X + Y).
@@ -57,14 +110,16 @@ static void wait_z(void)
  *   6. Wait GRIPPER_CLOSE_DELAY_MS for the servo to grip the piece.
  *   7. Raise Z to ROBOT_CONFIG_Z_TRAVEL.
  */
-static int do_pickup(chess_square_t sq)
+static int do_pickup(chess_square_t sq, const grip_offset_t *offset)
 {
-    int32_t x = file_to_x(sq.file);
-    int32_t y = rank_to_y(sq.rank);
+    int32_t x = file_to_x(sq.file) + offset->dx;
+    int32_t y = rank_to_y(sq.rank) + offset->dy;
 
     LOG_INF("Pickup: moving XY to file=%u rank=%u (%d,%d steps)",
             sq.file, sq.rank, x, y);
 
+    emit_phase(PLANNER_PHASE_PICKUP, sq, true, PLANNER_OK);
+
     /* ── Step 1: XY transit ─────────────────────────────────────────────── */
     int ret = robot_controller_start_xy_move(x, y, ROBOT_CONFIG_SPEED_TRAVEL_US);
     if (ret < 0) {
@@ -74,7 +129,7 @@ static int do_pickup(chess_square_t sq)
     wait_xy();
 
     /* ── Step 2: Descend Z and open gripper concurrently ────────────────── */
-    ret = robot_controller_start_z_move(ROBOT_CONFIG_Z_PICK, ROBOT_CONFIG_SPEED_Z_US);
+    ret = robot_controller_start_z_move(ROBOT_CONFIG_Z_PICK + offset->dz, ROBOT_CONFIG_SPEED_Z_US);
     if (ret < 0) {
         LOG_ERR("Pickup Z descend failed: %d", ret);
         return ret;
@@ -102,7 +157,7 @@ static int do_pickup(chess_square_t sq)
 }
 
 /**
- * @brief Place the currently held piece onto @p sq and release it.
+ * @brief Place the currently held piece onto @p sq (shifted by @p offset) and release it.
  *
  * Sequence:
  *   1. Move XY to the square (concurrent X + Y).
@@ -111,14 +166,16 @@ static int do_pickup(chess_square_t sq)
  *   4. Wait GRIPPER_OPEN_DELAY_MS for the servo to open.
  *   5. Raise Z to ROBOT_CONFIG_Z_TRAVEL.
  */
-static int do_place(chess_square_t sq)
+static int do_place(chess_square_t sq, const grip_offset_t *offset)
 {
-    int32_t x = file_to_x(sq.file);
-    int32_t y = rank_to_y(sq.rank);
+    int32_t x = file_to_x(sq.file) + offset->dx;
+    int32_t y = rank_to_y(sq.rank) + offset->dy;
 
     LOG_INF("Place: moving XY to file=%u rank=%u (%d,%d steps)",
             sq.file, sq.rank, x, y);
 
+    emit_phase(PLANNER_PHASE_PLACE, sq, true, PLANNER_OK);
+
     /* ── Step 1: XY transit ─────────────────────────────────────────────── */
     int ret = robot_controller_start_xy_move(x, y, ROBOT_CONFIG_SPEED_TRAVEL_US);
     if (ret < 0) {
@@ -128,7 +185,7 @@ static int do_place(chess_square_t sq)
     wait_xy();
 
     /* ── Step 2: Descend to place height ────────────────────────────────── */
-    ret = robot_controller_start_z_move(ROBOT_CONFIG_Z_PLACE, ROBOT_CONFIG_SPEED_Z_US);
+    ret = robot_controller_start_z_move(ROBOT_CONFIG_Z_PLACE + offset->dz, ROBOT_CONFIG_SPEED_Z_US);
     if (ret < 0) {
         LOG_ERR("Place Z descend failed: %d", ret);
         return ret;
@@ -163,6 +220,8 @@ static int do_place_at_graveyard(void)
     LOG_INF("Placing piece at graveyard (%d,%d steps)",
             ROBOT_CONFIG_GRAVEYARD_X, ROBOT_CONFIG_GRAVEYARD_Y);
 
+    emit_phase(PLANNER_PHASE_PLACE, (chess_square_t){0}, false, PLANNER_OK);
+
     /* ── Step 1: XY transit to graveyard ───────────────────────────────── */
     int ret = robot_controller_start_xy_move(
         ROBOT_CONFIG_GRAVEYARD_X,
@@ -198,6 +257,107 @@ static int do_place_at_graveyard(void)
     return 0;
 }
 
+/* ============================================================================
+ * Closed-loop verification
+ * ============================================================================ */
+
+/**
+ * @brief Check @p sq against a fresh sensor frame.
+ *
+ * @return 0 if the square matches @p expect_occupied or cannot be checked
+ *         (no probe registered, scan timed out), -EIO on a mismatch.
+ */
+static int verify_square(chess_square_t sq, bool expect_occupied)
+{
+    uint64_t mask;
+
+    if (!occupancy_probe) {
+        return 0;
+    }
+
+    int ret = occupancy_probe(&mask, K_MSEC(ROBOT_CONFIG_VERIFY_TIMEOUT_MS));
+    if (ret < 0) {
+        LOG_WRN("Verify %c%u: no sensor frame (%d), continuing unverified",
+                'a' + sq.file, sq.rank + 1, ret);
+        return 0;
+    }
+
+    bool occupied = (mask & square_bit(sq.file, sq.rank)) != 0;
+    return (occupied == expect_occupied) ? 0 : -EIO;
+}
+
+/**
+ * @brief Pick up @p sq and confirm the square emptied, retrying with offsets.
+ *
+ * @return 0 on success, negative errno on motor failure, -EIO if the piece
+ *         is still on the square after all retries.
+ */
+static int pickup_verified(chess_square_t sq)
+{
+    for (int attempt = 0; attempt <= ROBOT_CONFIG_GRIP_RETRIES; attempt++) {
+        int ret = do_pickup(sq, &grip_offsets[attempt]);
+        if (ret < 0) {
+            return ret;
+        }
+
+        if (verify_square(sq, false) == 0) {
+            return 0;
+        }
+
+        /* do_pickup() reopens the gripper on the way down for the next attempt */
+        LOG_WRN("Pickup at %c%u missed (attempt %d/%d)",
+                'a' + sq.file, sq.rank + 1, attempt + 1, ROBOT_CONFIG_GRIP_RETRIES + 1);
+    }
+
+    LOG_ERR("Pickup at %c%u failed after %d attempts",
+            'a' + sq.file, sq.rank + 1, ROBOT_CONFIG_GRIP_RETRIES + 1);
+    return -EIO;
+}
+
+/**
+ * @brief Place the held piece on @p sq and confirm the square filled.
+ *
+ * A piece that is not detected was either dropped off-centre or is still
+ * stuck in the gripper; both are recovered by gripping again around the
+ * square (the gripper opens on the way down) and placing once more.
+ *
+ * @return 0 on success, negative errno on motor failure, -EIO if the square
+ *         is still empty after all retries.
+ */
+static int place_verified(chess_square_t sq)
+{
+    int ret = do_place(sq, &grip_offsets[0]);
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (int attempt = 1; attempt <= ROBOT_CONFIG_GRIP_RETRIES; attempt++) {
+        if (verify_square(sq, true) == 0) {
+            return 0;
+        }
+
+        LOG_WRN("Place at %c%u not detected (attempt %d/%d)",
+                'a' + sq.file, sq.rank + 1, attempt, ROBOT_CONFIG_GRIP_RETRIES + 1);
+
+        ret = do_pickup(sq, &grip_offsets[attempt]);
+        if (ret < 0) {
+            return ret;
+        }
+        ret = do_place(sq, &grip_offsets[0]);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (verify_square(sq, true) == 0) {
+        return 0;
+    }
+
+    LOG_ERR("Place at %c%u failed after %d attempts",
+            'a' + sq.file, sq.rank + 1, ROBOT_CONFIG_GRIP_RETRIES + 1);
+    return -EIO;
+}
+
 /* ============================================================================
  * Public API
  * ============================================================================ */
@@ -210,12 +370,23 @@ void movement_planner_init(void)
             ROBOT_CONFIG_BOARD_ORIGIN_Y);
 }
 
-planner_result_t movement_planner_execute(const planner_action_t *action)
+void movement_planner_register_phase_callback(planner_phase_callback_t callback)
 {
-    if (!action) {
-        return PLANNER_ERR_INVALID;
-    }
+    phase_callback = callback;
+}
 
+void movement_planner_register_occupancy_probe(planner_occupancy_probe_t probe)
+{
+    occupancy_probe = probe;
+}
+
+planner_phase_t movement_planner_get_phase(void)
+{
+    return current_phase;
+}
+
+static planner_result_t execute_action(const planner_action_t *action)
+{
     int ret;
 
     switch (action->type) {
@@ -226,11 +397,11 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
                 'a' + action->from.file, action->from.rank + 1,
                 'a' + action->to.file,   action->to.rank + 1);
 
-        ret = do_pickup(action->from);
+        ret = pickup_verified(action->from);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
-        ret = do_place(action->to);
+        ret = place_verified(action->to);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
@@ -244,7 +415,7 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
                 'a' + action->to.file,   action->to.rank + 1);
 
         /* Remove opponent piece to graveyard */
-        ret = do_pickup(action->to);
+        ret = pickup_verified(action->to);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
@@ -253,11 +424,11 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
             return PLANNER_ERR_MOTOR;
         }
         /* Now execute the actual move */
-        ret = do_pickup(action->from);
+        ret = pickup_verified(action->from);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
-        ret = do_place(action->to);
+        ret = place_verified(action->to);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
@@ -271,7 +442,7 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
                 'a' + action->to.file,       action->to.rank + 1);
 
         /* Remove the en-passant captured pawn */
-        ret = do_pickup(action->captured);
+        ret = pickup_verified(action->captured);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
@@ -280,11 +451,11 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
             return PLANNER_ERR_MOTOR;
         }
         /* Move the capturing pawn */
-        ret = do_pickup(action->from);
+        ret = pickup_verified(action->from);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
-        ret = do_place(action->to);
+        ret = place_verified(action->to);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
@@ -301,20 +472,20 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
                 'a' + action->to2.file,   action->to2.rank + 1);
 
         /* Move rook first so it vacates its square before the king passes */
-        ret = do_pickup(action->from);
+        ret = pickup_verified(action->from);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
-        ret = do_place(action->to);
+        ret = place_verified(action->to);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
         /* Move king */
-        ret = do_pickup(action->from2);
+        ret = pickup_verified(action->from2);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
-        ret = do_place(action->to2);
+        ret = place_verified(action->to2);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
@@ -325,7 +496,7 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
         LOG_INF("Planner: REMOVE piece at %c%u",
                 'a' + action->from.file, action->from.rank + 1);
 
-        ret = do_pickup(action->from);
+        ret = pickup_verified(action->from);
         if (ret < 0) {
             return PLANNER_ERR_MOTOR;
         }
@@ -344,6 +515,24 @@ planner_result_t movement_planner_execute(const planner_action_t *action)
     return PLANNER_OK;
 }
 
+planner_result_t movement_planner_execute(planner_action_t *action)
+{
+    if (!action) {
+        return PLANNER_ERR_INVALID;
+    }
+
+    current_action = action;
+    emit_phase(PLANNER_PHASE_ACTION_BEGIN, (chess_square_t){0}, false, PLANNER_OK);
+
+    planner_result_t result = execute_action(action);
+
+    emit_phase(PLANNER_PHASE_ACTION_END, (chess_square_t){0}, false, result);
+    current_action = NULL;
+    current_phase = PLANNER_PHASE_IDLE;
+
+    return result;
+}
+
 int movement_planner_parse_square(const char *str, chess_square_t *out)
 {
     if (!str || !out) {
@@ -9,6 +9,7 @@
 #include "servo_manager.h"
 #include "servo_config.h"
 #include "movement_planner.h"
+#include "action_trace.h"
 #include "robot_config.h"
 
 LOG_MODULE_REGISTER(robot_controller, LOG_LEVEL_INF);
@@ -28,11 +29,19 @@ static servo_motor_t *gripper_servo = NULL;
 /* Homing state */
 static volatile homing_state_t homing_state = HOMING_STATE_IDLE;
 
-K_MSGQ_DEFINE(action_queue, sizeof(planner_action_t), 4,
+K_MSGQ_DEFINE(action_queue, sizeof(planner_action_t), ROBOT_ACTION_QUEUE_DEPTH,
               _Alignof(planner_action_t));
 
+/* Serializes producers so a batch is checked for room and queued as a unit */
+static K_MUTEX_DEFINE(enqueue_lock);
+static uint16_t next_batch = 1;
+
+/* Batch whose remaining actions are skipped after a failure; robot thread only */
+static uint16_t aborted_batch;
+
 static volatile bool planner_active = false;
 static robot_action_complete_cb_t action_complete_cb = NULL;
+static robot_motion_start_cb_t motion_start_cb = NULL;
 
 static void motor_move_complete(stepper_motor_t *motor)
 {
@@ -49,79 +58,15 @@ int robot_controller_init(void)
         return ret;
     }
     
-    motor_x = stepper_motor_create(
-        DEVICE_DT_GET(STEPPER_X_PULSE_PORT), STEPPER_X_PULSE_PIN,
-        DEVICE_DT_GET(STEPPER_X_DIR_PORT), STEPPER_X_DIR_PIN,
-        DEVICE_DT_GET(STEPPER_X_ENABLE_PORT), STEPPER_X_ENABLE_PIN
-    );
-    if (!motor_x) {
-        LOG_ERR("Failed to create X motor");
-        return -ENOMEM;
-    }
-    
-    motor_y1 = stepper_motor_create(
-        DEVICE_DT_GET(STEPPER_Y1_PULSE_PORT), STEPPER_Y1_PULSE_PIN,
-        DEVICE_DT_GET(STEPPER_Y1_DIR_PORT), STEPPER_Y1_DIR_PIN,
-        DEVICE_DT_GET(STEPPER_Y1_ENABLE_PORT), STEPPER_Y1_ENABLE_PIN
-    );
-    if (!motor_y1) {
-        LOG_ERR("Failed to create Y1 motor");
-        return -ENOMEM;
-    }
+    motor_x  = stepper_manager_get_motor(STEPPER_ID_X_AXIS);
+    motor_y1 = stepper_manager_get_motor(STEPPER_ID_Y1_AXIS);
+    motor_y2 = stepper_manager_get_motor(STEPPER_ID_Y2_AXIS);
+    motor_z  = stepper_manager_get_motor(STEPPER_ID_Z_AXIS);
 
-    motor_y2 = stepper_motor_create(
-        DEVICE_DT_GET(STEPPER_Y2_PULSE_PORT), STEPPER_Y2_PULSE_PIN,
-        DEVICE_DT_GET(STEPPER_Y2_DIR_PORT), STEPPER_Y2_DIR_PIN,
-        DEVICE_DT_GET(STEPPER_Y2_ENABLE_PORT), STEPPER_Y2_ENABLE_PIN
-    );
-    if (!motor_y2) {
-        LOG_ERR("Failed to create Y2 motor");
-        return -ENOMEM;
+    for (int i = 0; i < STEPPER_MOTOR_COUNT; i++) {
+        stepper_motor_register_callback(stepper_motor_get(i), motor_move_complete);
     }
     
-    motor_z = stepper_motor_create(
-        DEVICE_DT_GET(STEPPER_Z_PULSE_PORT), STEPPER_Z_PULSE_PIN,
-        DEVICE_DT_GET(STEPPER_Z_DIR_PORT), STEPPER_Z_DIR_PIN,
-        DEVICE_DT_GET(STEPPER_Z_ENABLE_PORT), STEPPER_Z_ENABLE_PIN
-    );
-    if (!motor_z) {
-        LOG_ERR("Failed to create Z motor");
-        return -ENOMEM;
-    }
-    
-    ret = stepper_motor_init(motor_x);
-    if (ret < 0) {
-        LOG_ERR("Failed to initialize X motor: %d", ret);
-        return ret;
-    }
-    stepper_motor_register_callback(motor_x, motor_move_complete);
-    
-    ret = stepper_motor_init(motor_y1);
-    if (ret < 0) {
-        LOG_ERR("Failed to initialize Y1 motor: %d", ret);
-        return ret;
-    }
-    stepper_motor_register_callback(motor_y1, motor_move_complete);
-
-    ret = stepper_motor_init(motor_y2);
-    if (ret < 0) {
-        LOG_ERR("Failed to initialize Y2 motor: %d", ret);
-        return ret;
-    }
-    stepper_motor_register_callback(motor_y2, motor_move_complete);
-    
-    ret = stepper_motor_init(motor_z);
-    if (ret < 0) {
-        LOG_ERR("Failed to initialize Z motor: %d", ret);
-        return ret;
-    }
-    stepper_motor_register_callback(motor_z, motor_move_complete);
-    
-    stepper_manager_register_motor(STEPPER_ID_X_AXIS, motor_x);
-    stepper_manager_register_motor(STEPPER_ID_Y1_AXIS, motor_y1);
-    stepper_manager_register_motor(STEPPER_ID_Y2_AXIS, motor_y2);
-    stepper_manager_register_motor(STEPPER_ID_Z_AXIS, motor_z);
-    
     ret = stepper_manager_enable_all(true);
     if (ret < 0) {
         LOG_ERR("Failed to enable motors: %d", ret);
@@ -134,19 +79,7 @@ int robot_controller_init(void)
         return ret;
     }
     
-    gripper_servo = servo_motor_create(DEVICE_DT_GET(GRIPPER_SERVO_GPIO_PORT), GRIPPER_SERVO_GPIO_PIN, GRIPPER_SERVO_GPIO_FLAGS);
-    if (!gripper_servo) {
-        LOG_ERR("Failed to create gripper servo");
-        return -ENOMEM;
-    }
-    
-    ret = servo_motor_init(gripper_servo);
-    if (ret < 0) {
-        LOG_ERR("Failed to initialize gripper servo: %d", ret);
-        return ret;
-    }
-    
-    servo_manager_register_servo(SERVO_ID_1, gripper_servo);
+    gripper_servo = SERVO_MOTOR_DT_GET(GRIPPER_SERVO_NODE);
     
     movement_planner_init();
 
@@ -381,24 +314,96 @@ bool robot_controller_is_z_moving(void)
     return stepper_motor_is_moving(motor_z);
 }
 
+static int enqueue_one(const planner_action_t *action, uint16_t batch, uint8_t index,
+                       uint8_t size)
+{
+    planner_action_t queued = *action;
+
+    queued.batch = batch;
+    queued.batch_index = index;
+    queued.batch_size = size;
+    if (queued.trace.start_us == 0) {
+        queued.trace.start_us = action_trace_now_us();
+    }
+    queued.trace.enqueued_us = action_trace_mark(&queued.trace);
+
+    return k_msgq_put(&action_queue, &queued, K_NO_WAIT);
+}
+
 int robot_controller_enqueue_action(const planner_action_t *action)
 {
     if (!action) {
         return -EINVAL;
     }
 
-    int ret = k_msgq_put(&action_queue, action, K_NO_WAIT);
+    k_mutex_lock(&enqueue_lock, K_FOREVER);
+    int ret = enqueue_one(action, 0, 0, 1);
+    k_mutex_unlock(&enqueue_lock);
+
     if (ret < 0) {
         LOG_WRN("Action queue full – action dropped (ret=%d)", ret);
     }
     return ret;
 }
 
+int robot_controller_enqueue_batch(const planner_action_t *actions, size_t count)
+{
+    int ret = 0;
+
+    if (!actions || count == 0 || count > ROBOT_ACTION_QUEUE_DEPTH) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&enqueue_lock, K_FOREVER);
+
+    /* Only the robot thread takes from the queue, so the room can only grow */
+    if (k_msgq_num_free_get(&action_queue) < count) {
+        ret = -ENOMSG;
+    } else {
+        uint16_t batch = next_batch++;
+        if (next_batch == 0) {
+            next_batch = 1;
+        }
+
+        for (size_t i = 0; i < count && ret == 0; i++) {
+            ret = enqueue_one(&actions[i], batch, (uint8_t)i, (uint8_t)count);
+        }
+    }
+
+    k_mutex_unlock(&enqueue_lock);
+
+    if (ret < 0) {
+        LOG_WRN("Action queue cannot take a batch of %u (ret=%d)", (unsigned int)count, ret);
+    }
+    return ret;
+}
+
+uint32_t robot_controller_queue_depth(void)
+{
+    return k_msgq_num_used_get(&action_queue);
+}
+
 void robot_controller_set_action_complete_cb(robot_action_complete_cb_t cb)
 {
     action_complete_cb = cb;
 }
 
+void robot_controller_set_motion_start_cb(robot_motion_start_cb_t cb)
+{
+    motion_start_cb = cb;
+}
+
+static void check_motion_start(void)
+{
+    static bool was_moving;
+    bool moving = robot_controller_is_busy() || robot_controller_is_homing();
+
+    if (moving && !was_moving && motion_start_cb) {
+        motion_start_cb();
+    }
+    was_moving = moving;
+}
+
 void robot_controller_task(void)
 {
     planner_action_t pending;
@@ -413,9 +418,27 @@ void robot_controller_task(void)
         if (!robot_controller_is_homing() &&
             k_msgq_get(&action_queue, &pending, K_NO_WAIT) == 0) {
 
-            planner_active = true;
-            planner_result_t result = movement_planner_execute(&pending);
-            planner_active = false;
+            planner_result_t result;
+
+            pending.trace.dequeued_us = action_trace_mark(&pending.trace);
+
+            if (pending.batch != 0 && pending.batch == aborted_batch) {
+                result = PLANNER_ERR_ABORTED;
+            } else {
+                planner_active = true;
+                check_motion_start();
+                result = movement_planner_execute(&pending);
+                planner_active = false;
+
+                if (result != PLANNER_OK && pending.batch != 0) {
+                    aborted_batch = pending.batch;
+                }
+            }
+
+            pending.trace.completed_us = action_trace_mark(&pending.trace);
+            if (result != PLANNER_ERR_ABORTED) {
+                action_trace_record(&pending.trace);
+            }
 
             if (action_complete_cb) {
                 action_complete_cb(result, &pending);
@@ -423,6 +446,7 @@ void robot_controller_task(void)
         }
 
         robot_controller_update();
+        check_motion_start();
         k_sleep(K_USEC(100));
     }
 }
@@ -4,7 +4,7 @@
 
 LOG_MODULE_REGISTER(servo_manager, LOG_LEVEL_INF);
 
-static servo_motor_t *servos[MAX_SERVO_MOTORS];
+static servo_motor_t *servos[SERVO_ID_MAX];
 static bool initialized = false;
 
 int servo_manager_init(void)
@@ -13,34 +13,26 @@ int servo_manager_init(void)
         return 0;
     }
 
-    for (int i = 0; i < MAX_SERVO_MOTORS; i++) {
-        servos[i] = NULL;
-    }
-
-    initialized = true;
-    LOG_INF("Servo manager initialized");
-    return 0;
-}
-
-int servo_manager_register_servo(servo_id_t id, servo_motor_t *servo)
-{
-    if (!initialized) {
-        LOG_ERR("Servo manager not initialized");
-        return -EINVAL;
+    for (int i = 0; i < SERVO_MOTOR_COUNT; i++) {
+        int ret = servo_motor_init(servo_motor_get(i));
+        if (ret < 0) {
+            LOG_ERR("Failed to initialize servo %d: %d", i, ret);
+            return ret;
+        }
     }
 
-    if (id >= MAX_SERVO_MOTORS || !servo) {
-        return -EINVAL;
+    for (int i = 0; i < SERVO_ID_MAX; i++) {
+        servos[i] = servo_motor_get(i);
     }
 
-    servos[id] = servo;
-    LOG_INF("Registered servo %d", id);
+    initialized = true;
+    LOG_INF("Servo manager initialized with %d servos", SERVO_MOTOR_COUNT);
     return 0;
 }
 
 servo_motor_t *servo_manager_get_servo(servo_id_t id)
 {
-    if (!initialized || id >= MAX_SERVO_MOTORS) {
+    if (!initialized || id >= SERVO_ID_MAX) {
         return NULL;
     }
 
@@ -54,7 +46,7 @@ int servo_manager_enable_all(bool enable)
     }
 
     int ret;
-    for (int i = 0; i < MAX_SERVO_MOTORS; i++) {
+    for (int i = 0; i < SERVO_ID_MAX; i++) {
         if (servos[i]) {
             ret = servo_motor_enable(servos[i], enable);
             if (ret < 0) {
@@ -75,7 +67,7 @@ int servo_manager_set_all_angle(uint16_t angle_degrees)
     }
 
     int ret;
-    for (int i = 0; i < MAX_SERVO_MOTORS; i++) {
+    for (int i = 0; i < SERVO_ID_MAX; i++) {
         if (servos[i]) {
             ret = servo_motor_set_angle(servos[i], angle_degrees);
             if (ret < 0) {
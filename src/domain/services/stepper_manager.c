@@ -1,11 +1,14 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
-#include <string.h>
 #include "stepper_manager.h"
+#include "stepper_config.h"
 
 LOG_MODULE_REGISTER(stepper_manager, LOG_LEVEL_INF);
 
-static stepper_motor_t *motors[MAX_STEPPER_MOTORS];
+static stepper_motor_t *motors[STEPPER_ID_MAX];
+/* Every motor except the Y pair, which is stepped in lockstep */
+static stepper_motor_t *unpaired[STEPPER_MOTOR_COUNT];
+static int unpaired_count;
 static bool initialized = false;
 
 int stepper_manager_init(void)
@@ -14,39 +17,37 @@ int stepper_manager_init(void)
         return 0;
     }
     
-    memset(motors, 0, sizeof(motors));
-    initialized = true;
-    
-    LOG_INF("Stepper manager initialized");
-    return 0;
-}
-
-int stepper_manager_register_motor(stepper_id_t id, stepper_motor_t *motor)
-{
-    if (!initialized) {
-        LOG_ERR("Manager not initialized");
-        return -EINVAL;
-    }
-    
-    if (id >= MAX_STEPPER_MOTORS) {
-        LOG_ERR("Invalid motor ID: %d", id);
-        return -EINVAL;
+    for (int i = 0; i < STEPPER_MOTOR_COUNT; i++) {
+        stepper_motor_t *motor = stepper_motor_get(i);
+        int ret = stepper_motor_init(motor);
+        if (ret < 0) {
+            LOG_ERR("Failed to initialize %s: %d", stepper_motor_name(motor), ret);
+            return ret;
+        }
     }
-    
-    if (!motor) {
-        LOG_ERR("Motor pointer is NULL");
-        return -EINVAL;
+
+    motors[STEPPER_ID_X_AXIS]  = STEPPER_MOTOR_DT_GET(STEPPER_X_NODE);
+    motors[STEPPER_ID_Y1_AXIS] = STEPPER_MOTOR_DT_GET(STEPPER_Y1_NODE);
+    motors[STEPPER_ID_Y2_AXIS] = STEPPER_MOTOR_DT_GET(STEPPER_Y2_NODE);
+    motors[STEPPER_ID_Z_AXIS]  = STEPPER_MOTOR_DT_GET(STEPPER_Z_NODE);
+
+    unpaired_count = 0;
+    for (int i = 0; i < STEPPER_MOTOR_COUNT; i++) {
+        stepper_motor_t *motor = stepper_motor_get(i);
+        if (motor != motors[STEPPER_ID_Y1_AXIS] && motor != motors[STEPPER_ID_Y2_AXIS]) {
+            unpaired[unpaired_count++] = motor;
+        }
     }
+
+    initialized = true;
     
-    motors[id] = motor;
-    LOG_INF("Motor registered at ID %d", id);
-    
+    LOG_INF("Stepper manager initialized with %d motors", STEPPER_MOTOR_COUNT);
     return 0;
 }
 
 stepper_motor_t *stepper_manager_get_motor(stepper_id_t id)
 {
-    if (!initialized || id >= MAX_STEPPER_MOTORS) {
+    if (!initialized || id >= STEPPER_ID_MAX) {
         return NULL;
     }
     
@@ -59,24 +60,10 @@ void stepper_manager_update_all(void)
         return;
     }
 
-    bool y_pair_handled = false;
-
-    for (int i = 0; i < MAX_STEPPER_MOTORS; i++) {
-        if (!motors[i]) {
-            continue;
-        }
-
-        if (!y_pair_handled && i == STEPPER_ID_Y1_AXIS && motors[STEPPER_ID_Y2_AXIS]) {
-            stepper_motor_update_pair(motors[STEPPER_ID_Y1_AXIS], motors[STEPPER_ID_Y2_AXIS]);
-            y_pair_handled = true;
-            continue;
-        }
-
-        if (y_pair_handled && i == STEPPER_ID_Y2_AXIS) {
-            continue; /* already updated as a pair */
-        }
+    stepper_motor_update_pair(motors[STEPPER_ID_Y1_AXIS], motors[STEPPER_ID_Y2_AXIS]);
 
-        stepper_motor_update(motors[i]);
+    for (int i = 0; i < unpaired_count; i++) {
+        stepper_motor_update(unpaired[i]);
     }
 }
 
@@ -87,13 +74,12 @@ int stepper_manager_enable_all(bool enable)
     }
     
     int ret;
-    for (int i = 0; i < MAX_STEPPER_MOTORS; i++) {
-        if (motors[i]) {
-            ret = stepper_motor_enable(motors[i], enable);
-            if (ret < 0) {
-                LOG_ERR("Failed to %s motor %d", enable ? "enable" : "disable", i);
-                return ret;
-            }
+    for (int i = 0; i < STEPPER_MOTOR_COUNT; i++) {
+        stepper_motor_t *motor = stepper_motor_get(i);
+        ret = stepper_motor_enable(motor, enable);
+        if (ret < 0) {
+            LOG_ERR("Failed to %s %s", enable ? "enable" : "disable", stepper_motor_name(motor));
+            return ret;
         }
     }
     
@@ -107,13 +93,12 @@ int stepper_manager_stop_all(void)
     }
     
     int ret;
-    for (int i = 0; i < MAX_STEPPER_MOTORS; i++) {
-        if (motors[i]) {
-            ret = stepper_motor_stop(motors[i]);
-            if (ret < 0) {
-                LOG_ERR("Failed to stop motor %d", i);
-                return ret;
-            }
+    for (int i = 0; i < STEPPER_MOTOR_COUNT; i++) {
+        stepper_motor_t *motor = stepper_motor_get(i);
+        ret = stepper_motor_stop(motor);
+        if (ret < 0) {
+            LOG_ERR("Failed to stop %s", stepper_motor_name(motor));
+            return ret;
         }
     }
     
@@ -126,8 +111,8 @@ bool stepper_manager_all_idle(void)
         return true;
     }
     
-    for (int i = 0; i < MAX_STEPPER_MOTORS; i++) {
-        if (motors[i] && stepper_motor_is_moving(motors[i])) {
+    for (int i = 0; i < STEPPER_MOTOR_COUNT; i++) {
+        if (stepper_motor_is_moving(stepper_motor_get(i))) {
             return false;
         }
     }
@@ -7,24 +7,32 @@
 LOG_MODULE_REGISTER(servo_motor, LOG_LEVEL_INF);
 
 struct servo_motor {
-    const struct device *gpio_port;
-    uint32_t gpio_pin;
-    gpio_dt_flags_t gpio_flags;
+    struct gpio_dt_spec control;
     uint16_t current_angle;
     uint32_t current_pulse_us;
+    volatile bool ready; /* control pin configured */
     volatile bool enabled;
 };
 
-/* Single global servo instance – registered by servo_motor_create() */
-static servo_motor_t *g_servo = NULL;
+#define SERVO_MOTOR_DEFINE(node_id)                                   \
+    [SERVO_MOTOR_DT_INDEX(node_id)] = {                               \
+        .control = GPIO_DT_SPEC_GET(node_id, control_gpios),          \
+        .current_angle = 90,                                          \
+        .current_pulse_us = (SERVO_MIN_PULSE_US + SERVO_MAX_PULSE_US) / 2, \
+    },
+
+static servo_motor_t servos[SERVO_MOTOR_COUNT] = {
+    DT_FOREACH_STATUS_OKAY(custom_servo, SERVO_MOTOR_DEFINE)
+};
 
 /* ─────────────────────────────────────────────────────────────────────────────
  * Dedicated PWM thread
  *
- * HIGH phase: k_busy_wait(pulse_us)  – busy-spin for microsecond accuracy
+ * HIGH phase: k_busy_wait(pulse_us)  – busy-spin for microsecond accuracy,
+ *                                      one servo after the other
  * LOW  phase: k_msleep(18)           – ~18 ms sleep; CPU is free for steppers
  *
- * Total cycle ≈ 18.5–20.5 ms (~49–54 Hz).
+ * Total cycle ≈ 18.5–20.5 ms (~49–54 Hz) per servo.
  * RC servos accept 15–25 ms periods; only pulse width determines position.
  *
  * Thread runs at priority 4 (higher than the rest at 5) so it cannot be
@@ -37,30 +45,32 @@ static void servo_pwm_thread_fn(void *p1, void *p2, void *p3)
     ARG_UNUSED(p3);
 
     while (1) {
-        servo_motor_t *s = g_servo;
+        bool pulsed = false;
 
-        if (!s) {
-            // Wait for servo to be created
-             k_msleep(100);
-             continue;
-        }
+        for (int i = 0; i < SERVO_MOTOR_COUNT; i++) {
+            servo_motor_t *s = &servos[i];
 
-        if (!s->enabled) {
-            // Be explicit about inactive state while disabled
-            gpio_pin_set(s->gpio_port, s->gpio_pin, 0); 
-            k_msleep(20);
-            continue;
-        }
+            if (!s->ready) {
+                continue;
+            }
 
-        uint32_t pulse_us = s->current_pulse_us;
+            if (!s->enabled) {
+                // Be explicit about inactive state while disabled
+                gpio_pin_set_dt(&s->control, 0);
+                continue;
+            }
 
-        /* Accurate HIGH pulse */
-        gpio_pin_set(s->gpio_port, s->gpio_pin, 1);
-        k_busy_wait(pulse_us);
-        gpio_pin_set(s->gpio_port, s->gpio_pin, 0);
+            uint32_t pulse_us = s->current_pulse_us;
+
+            /* Accurate HIGH pulse */
+            gpio_pin_set_dt(&s->control, 1);
+            k_busy_wait(pulse_us);
+            gpio_pin_set_dt(&s->control, 0);
+            pulsed = true;
+        }
 
         /* LOW gap – sleep frees the CPU for stepper and network threads */
-        k_msleep(18);
+        k_msleep(pulsed ? 18 : 20);
     }
 }
 
@@ -68,28 +78,13 @@ K_THREAD_DEFINE(servo_pwm_tid, 2048,
                 servo_pwm_thread_fn, NULL, NULL, NULL,
                 4, 0, 0);
 
-servo_motor_t *servo_motor_create(const struct device *gpio_port, uint32_t gpio_pin, gpio_dt_flags_t gpio_flags)
+servo_motor_t *servo_motor_get(int index)
 {
-    if (!gpio_port) {
+    if (index < 0 || index >= SERVO_MOTOR_COUNT) {
         return NULL;
     }
 
-    servo_motor_t *servo = k_malloc(sizeof(servo_motor_t));
-    if (!servo) {
-        return NULL;
-    }
-
-    servo->gpio_port = gpio_port;
-    servo->gpio_pin = gpio_pin;
-    servo->gpio_flags = gpio_flags;
-    servo->current_angle = 90;
-    servo->current_pulse_us = (SERVO_MIN_PULSE_US + SERVO_MAX_PULSE_US) / 2;
-    servo->enabled = false;
-
-    /* Register as the single active servo for the PWM thread */
-    g_servo = servo;
-
-    return servo;
+    return &servos[index];
 }
 
 int servo_motor_init(servo_motor_t *servo)
@@ -98,19 +93,20 @@ int servo_motor_init(servo_motor_t *servo)
         return -EINVAL;
     }
 
-    if (!device_is_ready(servo->gpio_port)) {
+    if (!gpio_is_ready_dt(&servo->control)) {
         LOG_ERR("GPIO port not ready");
         return -ENODEV;
     }
 
-    int ret = gpio_pin_configure(servo->gpio_port, servo->gpio_pin, GPIO_OUTPUT_INACTIVE | servo->gpio_flags);
+    int ret = gpio_pin_configure_dt(&servo->control, GPIO_OUTPUT_INACTIVE);
     if (ret < 0) {
         LOG_ERR("Failed to configure GPIO pin: %d", ret);
         return ret;
     }
 
     servo->enabled = false;
-    LOG_INF("Servo motor initialized on GPIO pin %u", servo->gpio_pin);
+    servo->ready = true;
+    LOG_INF("Servo motor initialized on GPIO pin %u", servo->control.pin);
     return 0;
 }
 
@@ -165,14 +161,14 @@ int servo_motor_enable(servo_motor_t *servo, bool enable)
     }
 
     LOG_INF("servo_motor_enable: enable=%d, current_enabled=%d, port=%p, pin=%u",
-            enable, servo->enabled, servo->gpio_port, servo->gpio_pin);
+            enable, servo->enabled, servo->control.port, servo->control.pin);
 
     if (enable && !servo->enabled) {
         servo->enabled = true;
         LOG_INF("Servo enabled at %u degrees (pulse=%u us)", servo->current_angle, servo->current_pulse_us);
     } else if (!enable && servo->enabled) {
         servo->enabled = false;
-        gpio_pin_set(servo->gpio_port, servo->gpio_pin, 0);
+        gpio_pin_set_dt(&servo->control, 0);
         LOG_INF("Servo disabled");
     }
 
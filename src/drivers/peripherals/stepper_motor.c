@@ -8,12 +8,10 @@
 LOG_MODULE_REGISTER(stepper_motor, LOG_LEVEL_INF);
 
 struct stepper_motor {
-	const struct device *pulse_port;
-	uint32_t pulse_pin;
-	const struct device *dir_port;
-	uint32_t dir_pin;
-	const struct device *enable_port;
-	uint32_t enable_pin;
+	struct gpio_dt_spec pulse;
+	struct gpio_dt_spec dir;
+	struct gpio_dt_spec enable; /* port is NULL if the node has no enable-gpios */
+	const char *name;
     
 	int32_t current_position;
 	int32_t target_position;
@@ -28,39 +26,39 @@ struct stepper_motor {
 	stepper_move_complete_callback_t callback;
 };
 
+#define STEPPER_MOTOR_DEFINE(node_id)                                        \
+	[STEPPER_MOTOR_DT_INDEX(node_id)] = {                                    \
+		.pulse = GPIO_DT_SPEC_GET(node_id, pulse_gpios),                     \
+		.dir = GPIO_DT_SPEC_GET(node_id, dir_gpios),                         \
+		.enable = GPIO_DT_SPEC_GET_OR(node_id, enable_gpios, {0}),           \
+		.name = DT_NODE_FULL_NAME(node_id),                                  \
+		.step_delay_us = 1000,                                               \
+		.state = STEPPER_STATE_IDLE,                                         \
+		.direction = STEPPER_DIR_CW,                                         \
+		.dir_inverted = DT_PROP(node_id, dir_inverted),                      \
+	},
+
+static stepper_motor_t motors[STEPPER_MOTOR_COUNT] = {
+	DT_FOREACH_STATUS_OKAY(custom_stepper, STEPPER_MOTOR_DEFINE)
+};
+
 static inline uint64_t now_us(void)
 {
 	return k_cyc_to_us_floor64(k_cycle_get_64());
 }
 
-stepper_motor_t *stepper_motor_create(const struct device *pulse_port, uint32_t pulse_pin,
-									  const struct device *dir_port, uint32_t dir_pin,
-									  const struct device *enable_port, uint32_t enable_pin)
+stepper_motor_t *stepper_motor_get(int index)
 {
-	stepper_motor_t *motor = k_malloc(sizeof(stepper_motor_t));
-	if (!motor) {
+	if (index < 0 || index >= STEPPER_MOTOR_COUNT) {
 		return NULL;
 	}
-    
-	motor->pulse_port = pulse_port;
-	motor->pulse_pin = pulse_pin;
-	motor->dir_port = dir_port;
-	motor->dir_pin = dir_pin;
-	motor->enable_port = enable_port;
-	motor->enable_pin = enable_pin;
-    
-	motor->current_position = 0;
-	motor->target_position = 0;
-	motor->step_delay_us = 1000;
-	motor->next_step_time = 0;
-    
-	motor->state = STEPPER_STATE_IDLE;
-	motor->direction = STEPPER_DIR_CW;
-	motor->enabled = false;
-	motor->dir_inverted = false;
-	motor->callback = NULL;
-    
-	return motor;
+
+	return &motors[index];
+}
+
+const char *stepper_motor_name(const stepper_motor_t *motor)
+{
+	return motor ? motor->name : "none";
 }
 
 int stepper_motor_init(stepper_motor_t *motor)
@@ -71,37 +69,34 @@ int stepper_motor_init(stepper_motor_t *motor)
 		return -EINVAL;
 	}
     
-	if (!device_is_ready(motor->pulse_port)) {
-		LOG_ERR("Pulse GPIO port not ready");
-		return -ENODEV;
-	}
-    
-	if (!device_is_ready(motor->dir_port)) {
-		LOG_ERR("Direction GPIO port not ready");
+	if (!gpio_is_ready_dt(&motor->pulse) || !gpio_is_ready_dt(&motor->dir)) {
+		LOG_ERR("%s: step/direction GPIO port not ready", motor->name);
 		return -ENODEV;
 	}
     
-	if (!device_is_ready(motor->enable_port)) {
-		LOG_ERR("Enable GPIO port not ready");
+	if (motor->enable.port && !gpio_is_ready_dt(&motor->enable)) {
+		LOG_ERR("%s: enable GPIO port not ready", motor->name);
 		return -ENODEV;
 	}
     
-	ret = gpio_pin_configure(motor->pulse_port, motor->pulse_pin, GPIO_OUTPUT_INACTIVE);
+	ret = gpio_pin_configure_dt(&motor->pulse, GPIO_OUTPUT_INACTIVE);
 	if (ret < 0) {
-		LOG_ERR("Failed to configure pulse pin: %d", ret);
+		LOG_ERR("%s: failed to configure pulse pin: %d", motor->name, ret);
 		return ret;
 	}
     
-	ret = gpio_pin_configure(motor->dir_port, motor->dir_pin, GPIO_OUTPUT_INACTIVE);
+	ret = gpio_pin_configure_dt(&motor->dir, GPIO_OUTPUT_INACTIVE);
 	if (ret < 0) {
-		LOG_ERR("Failed to configure direction pin: %d", ret);
+		LOG_ERR("%s: failed to configure direction pin: %d", motor->name, ret);
 		return ret;
 	}
     
-	ret = gpio_pin_configure(motor->enable_port, motor->enable_pin, GPIO_OUTPUT_ACTIVE);
-	if (ret < 0) {
-		LOG_ERR("Failed to configure enable pin: %d", ret);
-		return ret;
+	if (motor->enable.port) {
+		ret = gpio_pin_configure_dt(&motor->enable, GPIO_OUTPUT_ACTIVE);
+		if (ret < 0) {
+			LOG_ERR("%s: failed to configure enable pin: %d", motor->name, ret);
+			return ret;
+		}
 	}
     
 	motor->enabled = false;
@@ -118,10 +113,12 @@ int stepper_motor_enable(stepper_motor_t *motor, bool enable)
 		return -EINVAL;
 	}
     
-	ret = gpio_pin_set(motor->enable_port, motor->enable_pin, enable ? 0 : 1);
-	if (ret < 0) {
-		LOG_ERR("Failed to set enable pin: %d", ret);
-		return ret;
+	if (motor->enable.port) {
+		ret = gpio_pin_set_dt(&motor->enable, enable ? 0 : 1);
+		if (ret < 0) {
+			LOG_ERR("%s: failed to set enable pin: %d", motor->name, ret);
+			return ret;
+		}
 	}
     
 	motor->enabled = enable;
@@ -154,7 +151,7 @@ int stepper_motor_move_steps(stepper_motor_t *motor, int32_t steps, uint32_t ste
 	motor->next_step_time = now_us();
     
 	motor->direction = (steps > 0) ? STEPPER_DIR_CW : STEPPER_DIR_CCW;
-	gpio_pin_set(motor->dir_port, motor->dir_pin, motor->direction ^ motor->dir_inverted);
+	gpio_pin_set_dt(&motor->dir, motor->direction ^ motor->dir_inverted);
     
 	return 0;
 }
@@ -193,8 +190,8 @@ int stepper_motor_move_steps_sync(stepper_motor_t *motor_a, stepper_motor_t *mot
 	motor_a->direction = dir;
 	motor_b->direction = dir;
 
-	gpio_pin_set(motor_a->dir_port, motor_a->dir_pin, dir ^ motor_a->dir_inverted);
-	gpio_pin_set(motor_b->dir_port, motor_b->dir_pin, dir ^ motor_b->dir_inverted);
+	gpio_pin_set_dt(&motor_a->dir, dir ^ motor_a->dir_inverted);
+	gpio_pin_set_dt(&motor_b->dir, dir ^ motor_b->dir_inverted);
 
 	return 0;
 }
@@ -273,9 +270,9 @@ void stepper_motor_update(stepper_motor_t *motor)
 		return;
 	}
     
-	gpio_pin_set(motor->pulse_port, motor->pulse_pin, 1);
+	gpio_pin_set_dt(&motor->pulse, 1);
 	k_busy_wait(5);
-	gpio_pin_set(motor->pulse_port, motor->pulse_pin, 0);
+	gpio_pin_set_dt(&motor->pulse, 0);
     
 	if (motor->direction == STEPPER_DIR_CW) {
 		motor->current_position++;
@@ -321,11 +318,11 @@ void stepper_motor_update_pair(stepper_motor_t *motor_a, stepper_motor_t *motor_
 			return;
 		}
 
-		gpio_pin_set(motor_a->pulse_port, motor_a->pulse_pin, 1);
-		gpio_pin_set(motor_b->pulse_port, motor_b->pulse_pin, 1);
+		gpio_pin_set_dt(&motor_a->pulse, 1);
+		gpio_pin_set_dt(&motor_b->pulse, 1);
 		k_busy_wait(5);
-		gpio_pin_set(motor_a->pulse_port, motor_a->pulse_pin, 0);
-		gpio_pin_set(motor_b->pulse_port, motor_b->pulse_pin, 0);
+		gpio_pin_set_dt(&motor_a->pulse, 0);
+		gpio_pin_set_dt(&motor_b->pulse, 0);
 
 		if (motor_a->direction == STEPPER_DIR_CW) {
 			motor_a->current_position++;
@@ -381,7 +378,7 @@ int stepper_motor_start_homing(stepper_motor_t *motor, stepper_direction_t direc
 	motor->next_step_time = now_us();
 	
 	/* Set direction pin */
-	gpio_pin_set(motor->dir_port, motor->dir_pin, direction ^ motor->dir_inverted);
+	gpio_pin_set_dt(&motor->dir, direction ^ motor->dir_inverted);
 	
 	LOG_INF("Motor homing started (dir=%d, speed=%u us)", direction, step_delay_us);
 	return 0;
@@ -414,8 +411,8 @@ int stepper_motor_start_homing_sync(stepper_motor_t *motor_a, stepper_motor_t *m
 	motor_b->next_step_time = now;
 	
 	/* Set direction pins */
-	gpio_pin_set(motor_a->dir_port, motor_a->dir_pin, direction ^ motor_a->dir_inverted);
-	gpio_pin_set(motor_b->dir_port, motor_b->dir_pin, direction ^ motor_b->dir_inverted);
+	gpio_pin_set_dt(&motor_a->dir, direction ^ motor_a->dir_inverted);
+	gpio_pin_set_dt(&motor_b->dir, direction ^ motor_b->dir_inverted);
 	
 	LOG_INF("Y-axis homing started (dir=%d, speed=%u us)", direction, step_delay_us);
 	return 0;
@@ -6,6 +6,7 @@
 #include "mqtt_client.h"
 #include "application.h"
 #include "robot_controller.h"
+#include "json_arena.h"
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
@@ -21,6 +22,9 @@ int main(void)
 {
     int ret;
 
+    /* Before any thread can touch cJSON */
+    json_arena_init();
+
     LOG_DBG("Network initializing...");
     ret = network_init();
     if (ret < 0) {
@@ -72,18 +76,21 @@ int main(void)
                     mqtt_client_thread,
                     NULL, NULL, NULL,
                     THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&mqtt_client_thread_data, "mqtt_client");
 
     k_thread_create(&application_thread_data, application_stack,
                     K_THREAD_STACK_SIZEOF(application_stack),
                     (k_thread_entry_t)application_task,
                     NULL, NULL, NULL,
                     THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&application_thread_data, "application");
 
     k_thread_create(&robot_controller_thread_data, robot_controller_stack,
                     K_THREAD_STACK_SIZEOF(robot_controller_stack),
                     (k_thread_entry_t)robot_controller_task,
                     NULL, NULL, NULL,
                     THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&robot_controller_thread_data, "robot");
 
     LOG_INF("System is ready");
 
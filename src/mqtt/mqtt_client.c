@@ -1,44 +1,441 @@
 #include <zephyr/kernel.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/net/mqtt.h>
+#include <zephyr/net/buf.h>
+#include <zephyr/zvfs/eventfd.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/random/random.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/sys/slist.h>
 #include <strings.h>
 #include "mqtt_client.h"
 #include "app_config.h"
 #include "network_config.h"
 #include "mdns_client.h"
+#include "mqtt_ingress.h"
+#include "json_writer.h"
 
 LOG_MODULE_REGISTER(mqtt_client, LOG_LEVEL_INF);
 
-#define MAX_SUBSCRIPTIONS 16
+#define MAX_SUBSCRIPTIONS CONFIG_APP_MQTT_MAX_SUBSCRIPTIONS
 
-static uint8_t rx_buffer[128];
-static uint8_t tx_buffer[128];
-static uint8_t payload_buffer[256];
+/* Open-addressing index over exact (wildcard-free) subscriptions, kept at most half full */
+#define SUB_INDEX_SIZE (2 * MAX_SUBSCRIPTIONS)
+#define SUB_TOPIC_MAX  64
+
+/*
+ * Outbound publish queue. Producers on any thread copy their message into a
+ * preallocated slot and return immediately; the MQTT thread is the only one
+ * that writes to the socket. Most messages fit a small slot, the few large
+ * ones (history dumps, health reports) take a large one.
+ */
+#define PUBLISH_TOPIC_MAX          64
+#define PUBLISH_SMALL_PAYLOAD_MAX  256
+#define PUBLISH_SMALL_SLOTS        16
+#define PUBLISH_LARGE_PAYLOAD_MAX  2048
+#define PUBLISH_LARGE_SLOTS        2
+#define OFFLINE_QUEUE_MAX          CONFIG_APP_MQTT_OFFLINE_QUEUE
+
+/*
+ * Inbound payloads are read straight from the socket into an ingress buffer
+ * sized for the message. Anything larger than CONFIG_APP_MQTT_RX_PAYLOAD_MAX,
+ * or arriving while the ingress queue is full, is drained and rejected.
+ */
+#define RX_PAYLOAD_MAX   CONFIG_APP_MQTT_RX_PAYLOAD_MAX
+#define RX_DRAIN_CHUNK   64
+
+/*
+ * The MQTT loop sleeps in poll() on the socket and on an eventfd that
+ * producers signal after queueing a publish. Without the eventfd the loop
+ * falls back to polling the queue at this interval.
+ */
+#define PUBLISH_FLUSH_INTERVAL_MS  20
+
+/*
+ * Reconnect backoff: the first retry follows almost immediately, later ones
+ * double up to the cap. Each delay is jittered between half and the full
+ * value so a broker restart is not hit by every client at the same time.
+ */
+#define RECONNECT_BACKOFF_MIN_MS 200
+#define RECONNECT_BACKOFF_MAX_MS 15000
+#define MDNS_BROWSE_TIMEOUT_MS   10000
+
+/*
+ * MQTT 5.0 headers carry properties (topic alias, user properties, the
+ * CONNACK's limits), so the packet buffers get more room.
+ */
+#if defined(CONFIG_APP_MQTT_V5)
+#define MQTT_PACKET_BUF_SIZE      256
+#define TOPIC_ALIAS_MAX           CONFIG_APP_MQTT_TOPIC_ALIASES
+#define CORRELATION_PROPERTY      "correlation-id"
+/* CONNACK reason code of a 5.0 broker that does not accept the version */
+#define CONNACK_UNSUPPORTED_PROTOCOL_VERSION 0x84
+#else
+#define MQTT_PACKET_BUF_SIZE      128
+#endif
+
+enum {
+    POLL_SOCKET = 0,
+    POLL_WAKE   = 1,
+};
+
+static uint8_t rx_buffer[MQTT_PACKET_BUF_SIZE];
+static uint8_t tx_buffer[MQTT_PACKET_BUF_SIZE];
 static struct mqtt_client client_ctx;
 static struct sockaddr_storage broker;
-static struct pollfd fds;
+
+typedef enum {
+    BROKER_SOURCE_CACHE,
+    BROKER_SOURCE_MDNS,
+    BROKER_SOURCE_STATIC,
+} broker_source_t;
+
+/* Last broker that completed a CONNACK; tried first on reconnect */
+static struct sockaddr_in cached_broker;
+static bool broker_cached;
+static broker_source_t broker_source;
+/* Set by the mDNS listener when the broker announces a new address */
+static atomic_t broker_moved = ATOMIC_INIT(0);
+
+/* MQTT 5.0 until a broker turns it down, then 3.1.1 until the broker moves */
+static bool mqtt_v5 = IS_ENABLED(CONFIG_APP_MQTT_V5);
+
+/* Reconnect statistics, reported in chess/system/online */
+static uint32_t reconnect_count;
+static uint32_t last_reconnect_ms;
+static struct pollfd fds[2];
+static int wake_fd = -1;
 
 typedef struct {
-    char topic[64];
+    char topic[SUB_TOPIC_MAX];
+    uint16_t len;
+    uint32_t hash;
+    bool wildcard;
+    mqtt_priority_t prio;
     mqtt_message_callback_t callback;
     bool active;
 } mqtt_subscription_t;
 
 static mqtt_subscription_t subscriptions[MAX_SUBSCRIPTIONS];
+static uint8_t sub_index[SUB_INDEX_SIZE]; /* subscription slot + 1, 0 = empty */
 static bool mqtt_connected = false;
 
+typedef struct {
+    union {
+        void *fifo_reserved; /* used by k_fifo */
+        sys_snode_t node;    /* offline ring and in-flight list */
+    };
+    struct k_mem_slab *slab;
+    char topic[PUBLISH_TOPIC_MAX];
+    uint32_t len;
+    uint32_t correlation_id; /* 0 = none; MQTT 5.0 user property */
+    uint16_t message_id; /* kept for the DUP resend after a reconnect */
+    uint8_t qos;
+    uint8_t policy;
+    bool retain;
+    uint8_t payload[];
+} publish_msg_t;
+
+K_MEM_SLAB_DEFINE_STATIC(publish_small_slab,
+                         ROUND_UP(sizeof(publish_msg_t) + PUBLISH_SMALL_PAYLOAD_MAX, 4),
+                         PUBLISH_SMALL_SLOTS, 4);
+K_MEM_SLAB_DEFINE_STATIC(publish_large_slab,
+                         ROUND_UP(sizeof(publish_msg_t) + PUBLISH_LARGE_PAYLOAD_MAX, 4),
+                         PUBLISH_LARGE_SLOTS, 4);
+static K_FIFO_DEFINE(publish_queue_high);
+static K_FIFO_DEFINE(publish_queue);
+/* QoS 1 messages sent but not acknowledged yet; MQTT thread only */
+static sys_slist_t publish_inflight;
+static atomic_t publish_dropped = ATOMIC_INIT(0);
+static atomic_t rx_rejected = ATOMIC_INIT(0);
+static uint16_t next_message_id = 1;
+
+static void publish_acked(uint16_t message_id);
+
+/* FNV-1a, cheap enough to run once per incoming publish */
+static uint32_t topic_hash(const uint8_t *topic, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= topic[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void sub_index_insert(int slot)
+{
+    uint32_t pos = subscriptions[slot].hash % SUB_INDEX_SIZE;
+
+    while (sub_index[pos] != 0) {
+        pos = (pos + 1) % SUB_INDEX_SIZE;
+    }
+    sub_index[pos] = (uint8_t)(slot + 1);
+}
+
+static const mqtt_subscription_t *sub_index_find(const uint8_t *topic, size_t len, uint32_t hash)
+{
+    uint32_t pos = hash % SUB_INDEX_SIZE;
+
+    while (sub_index[pos] != 0) {
+        const mqtt_subscription_t *sub = &subscriptions[sub_index[pos] - 1];
+        if (sub->hash == hash && sub->len == len && memcmp(sub->topic, topic, len) == 0) {
+            return sub;
+        }
+        pos = (pos + 1) % SUB_INDEX_SIZE;
+    }
+
+    return NULL;
+}
+
+/*
+ * Match a topic against a filter with '+' (one level) and '#' (remaining
+ * levels, including none). Returns -1 on mismatch, otherwise a specificity
+ * score: literal levels count most, and a filter without '#' beats one with.
+ */
+static int topic_filter_match(const char *filter, const uint8_t *topic, size_t len)
+{
+    size_t t = 0;
+    int literals = 0;
+
+    /* Wildcards never match $-prefixed system topics */
+    if (len > 0 && topic[0] == '$') {
+        return -1;
+    }
+
+    while (*filter) {
+        if (filter[0] == '#') {
+            return literals * 2;
+        }
+
+        if (filter[0] == '+') {
+            while (t < len && topic[t] != '/') {
+                t++;
+            }
+            filter++;
+        } else {
+            while (*filter && *filter != '/') {
+                if (t >= len || topic[t] != (uint8_t)*filter) {
+                    return -1;
+                }
+                t++;
+                filter++;
+            }
+            literals++;
+        }
+
+        if (*filter == '/') {
+            /* "a/#" also matches "a" itself */
+            if (t == len && filter[1] == '#') {
+                return literals * 2;
+            }
+            if (t >= len || topic[t] != '/') {
+                return -1;
+            }
+            t++;
+            filter++;
+        }
+    }
+
+    return t == len ? literals * 2 + 1 : -1;
+}
+
+/* Exact subscriptions win; otherwise the most specific wildcard filter */
+static const mqtt_subscription_t *find_subscription(const uint8_t *topic, size_t len)
+{
+    const mqtt_subscription_t *best = sub_index_find(topic, len, topic_hash(topic, len));
+    int best_score = -1;
+
+    if (best) {
+        return best;
+    }
+
+    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
+        if (!subscriptions[i].active || !subscriptions[i].wildcard) {
+            continue;
+        }
+        int score = topic_filter_match(subscriptions[i].topic, topic, len);
+        if (score > best_score) {
+            best_score = score;
+            best = &subscriptions[i];
+        }
+    }
+
+    return best;
+}
+
+/* Read a whole payload in chunks as the socket delivers it, NUL-terminated */
+static int read_payload_into(struct mqtt_client *const client, struct net_buf *buf, uint32_t len)
+{
+    while (buf->len < len) {
+        int ret = mqtt_read_publish_payload_blocking(client, net_buf_tail(buf), len - buf->len);
+        if (ret < 0) {
+            return ret;
+        }
+        if (ret == 0) {
+            return -EIO;
+        }
+        net_buf_add(buf, ret);
+    }
+
+    buf->data[buf->len] = '\0';
+    return 0;
+}
+
+/* The MQTT library expects the whole payload to be consumed before the next packet */
+static int drain_payload(struct mqtt_client *const client, uint32_t len)
+{
+    uint8_t scratch[RX_DRAIN_CHUNK];
+
+    while (len > 0) {
+        int ret = mqtt_read_publish_payload_blocking(client, scratch, MIN(len, sizeof(scratch)));
+        if (ret < 0) {
+            return ret;
+        }
+        if (ret == 0) {
+            return -EIO;
+        }
+        len -= ret;
+    }
+
+    return 0;
+}
+
+#if defined(CONFIG_APP_MQTT_V5)
+/*
+ * Outgoing topic aliases of the current connection. A topic's first
+ * publish carries the full name and binds an alias, later ones only send
+ * the alias. When all are taken, the least recently published topic gives
+ * its alias to the new one. MQTT thread only.
+ */
+typedef struct {
+    char topic[PUBLISH_TOPIC_MAX];
+    uint32_t hash;
+    uint32_t last_used; /* 0 = free */
+} topic_alias_t;
+
+static topic_alias_t topic_aliases[MAX(TOPIC_ALIAS_MAX, 1)];
+static uint16_t topic_alias_limit; /* our table size capped by the broker's maximum */
+static uint32_t topic_alias_clock;
+
+/* Aliases only live as long as the connection */
+static void topic_aliases_reset(uint16_t broker_max)
+{
+    memset(topic_aliases, 0, sizeof(topic_aliases));
+    topic_alias_limit = MIN(broker_max, TOPIC_ALIAS_MAX);
+    topic_alias_clock = 0;
+}
+
+/* Alias for @p topic, 0 if none; @p bound is set if the broker already knows it */
+static uint16_t topic_alias_get(const char *topic, bool *bound)
+{
+    size_t len = strlen(topic);
+    uint32_t hash = topic_hash((const uint8_t *)topic, len);
+    int lru = 0;
+
+    *bound = false;
+    if (topic_alias_limit == 0) {
+        return 0;
+    }
+
+    topic_alias_clock++;
+    for (int i = 0; i < topic_alias_limit; i++) {
+        topic_alias_t *alias = &topic_aliases[i];
+
+        if (alias->last_used != 0 && alias->hash == hash && strcmp(alias->topic, topic) == 0) {
+            alias->last_used = topic_alias_clock;
+            *bound = true;
+            return (uint16_t)(i + 1);
+        }
+        if (alias->last_used < topic_aliases[lru].last_used) {
+            lru = i;
+        }
+    }
+
+    /* Rebinding an alias in use is allowed; the PUBLISH carries the new topic */
+    memcpy(topic_aliases[lru].topic, topic, len + 1);
+    topic_aliases[lru].hash = hash;
+    topic_aliases[lru].last_used = topic_alias_clock;
+    return (uint16_t)(lru + 1);
+}
+
+/* Topic alias and correlation id of an outgoing publish */
+static void set_publish_properties(struct mqtt_publish_param *param, const publish_msg_t *msg,
+                                   char *id_buf, size_t id_size)
+{
+    bool bound;
+    uint16_t alias = topic_alias_get(msg->topic, &bound);
+
+    if (alias != 0) {
+        param->prop.topic_alias = alias;
+        if (bound) {
+            param->message.topic.topic.size = 0;
+        }
+    }
+
+    if (msg->correlation_id != 0) {
+        int len = snprintk(id_buf, id_size, "%u", msg->correlation_id);
+
+        param->prop.user_prop[0].name.utf8 = (uint8_t *)CORRELATION_PROPERTY;
+        param->prop.user_prop[0].name.size = sizeof(CORRELATION_PROPERTY) - 1;
+        param->prop.user_prop[0].value.utf8 = (uint8_t *)id_buf;
+        param->prop.user_prop[0].value.size = len;
+    }
+}
+
+/* Numeric "correlation-id" user property of an incoming publish, 0 if absent */
+static uint32_t publish_correlation_id(const struct mqtt_publish_param *pub)
+{
+    for (int i = 0; i < ARRAY_SIZE(pub->prop.user_prop); i++) {
+        const struct mqtt_utf8_pair *prop = &pub->prop.user_prop[i];
+        uint32_t id = 0;
+
+        if (prop->name.size != sizeof(CORRELATION_PROPERTY) - 1 ||
+            memcmp(prop->name.utf8, CORRELATION_PROPERTY, prop->name.size) != 0) {
+            continue;
+        }
+
+        for (uint32_t c = 0; c < prop->value.size; c++) {
+            uint8_t digit = prop->value.utf8[c] - '0';
+            if (digit > 9 || id > (UINT32_MAX - digit) / 10) {
+                return 0;
+            }
+            id = id * 10 + digit;
+        }
+        return id;
+    }
+
+    return 0;
+}
+
+/* A broker that does not speak 5.0 answers with one of these two codes */
+static void connack_refused(int result)
+{
+    if (mqtt_v5 && (result == MQTT_UNACCEPTABLE_PROTOCOL_VERSION ||
+                    result == CONNACK_UNSUPPORTED_PROTOCOL_VERSION)) {
+        LOG_WRN("Broker does not accept MQTT 5.0, falling back to 3.1.1");
+        mqtt_v5 = false;
+    }
+}
+#endif
+
 static void mqtt_evt_handler(struct mqtt_client *const client, const struct mqtt_evt *evt)
 {
     switch (evt->type) {
     case MQTT_EVT_CONNACK:
         if (evt->result == 0) {
             LOG_INF("MQTT client connected");
+#if defined(CONFIG_APP_MQTT_V5)
+            topic_aliases_reset(mqtt_v5 ? evt->param.connack.prop.topic_alias_maximum : 0);
+#endif
             mqtt_connected = true;
         } else {
             LOG_ERR("MQTT connection failed: %d", evt->result);
+#if defined(CONFIG_APP_MQTT_V5)
+            connack_refused(evt->result);
+#endif
         }
         break;
 
@@ -49,28 +446,46 @@ static void mqtt_evt_handler(struct mqtt_client *const client, const struct mqtt
 
     case MQTT_EVT_PUBLISH: {
         const struct mqtt_publish_param *pub = &evt->param.publish;
+        const uint8_t *topic = pub->message.topic.topic.utf8;
+        size_t topic_len = pub->message.topic.topic.size;
         uint32_t payload_len = pub->message.payload.len;
-        
-        if (payload_len > sizeof(payload_buffer)) {
-            payload_len = sizeof(payload_buffer);
+        const mqtt_subscription_t *sub = find_subscription(topic, topic_len);
+        struct net_buf *buf = NULL;
+        uint32_t correlation_id = 0;
+        int ret;
+
+#if defined(CONFIG_APP_MQTT_V5)
+        correlation_id = publish_correlation_id(pub);
+#endif
+
+        if (sub && sub->callback) {
+            buf = mqtt_ingress_alloc(payload_len, sub->prio);
+        }
+
+        if (buf) {
+            ret = read_payload_into(client, buf, payload_len);
+            if (ret == 0) {
+                /* The worker runs the callback and releases the buffer */
+                (void)mqtt_ingress_submit(buf, topic, topic_len, sub->callback, sub->prio,
+                                          correlation_id);
+            } else {
+                net_buf_unref(buf);
+            }
+        } else {
+            ret = drain_payload(client, payload_len);
+            if (ret == 0 && sub) {
+                LOG_WRN("Rejected %u byte payload on %.*s (%s, %u rejected so far)",
+                        payload_len, (int)topic_len, (const char *)topic,
+                        payload_len > RX_PAYLOAD_MAX ? "too large" : "queue full",
+                        (unsigned int)atomic_inc(&rx_rejected) + 1);
+            }
         }
 
-        int ret = mqtt_read_publish_payload(client, payload_buffer, payload_len);
         if (ret < 0) {
             LOG_ERR("Failed to read payload: %d", ret);
             break;
         }
 
-        for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
-            if (subscriptions[i].active && subscriptions[i].callback) {
-                if (pub->message.topic.topic.size == strlen(subscriptions[i].topic) &&
-                    memcmp(pub->message.topic.topic.utf8, subscriptions[i].topic, 
-                           pub->message.topic.topic.size) == 0) {
-                    subscriptions[i].callback(subscriptions[i].topic, payload_buffer, ret);
-                }
-            }
-        }
-
         if (pub->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
             struct mqtt_puback_param ack = {
                 .message_id = pub->message_id
@@ -82,6 +497,7 @@ static void mqtt_evt_handler(struct mqtt_client *const client, const struct mqtt
 
     case MQTT_EVT_PUBACK:
         LOG_DBG("MQTT PUBACK received");
+        publish_acked(evt->param.puback.message_id);
         break;
 
     case MQTT_EVT_SUBACK:
@@ -113,32 +529,77 @@ static int broker_from_static(struct sockaddr_in *out)
     return -ENOENT;
 }
 
-static int mqtt_broker_connect(void)
+static const char *broker_source_name(broker_source_t source)
 {
-    struct sockaddr_in *broker4 = (struct sockaddr_in *)&broker;
-    int ret;
+    switch (source) {
+    case BROKER_SOURCE_CACHE:  return "cache";
+    case BROKER_SOURCE_MDNS:   return "mdns";
+    case BROKER_SOURCE_STATIC: return "static";
+    default:                   return "unknown";
+    }
+}
 
-    LOG_INF("Discovering MQTT broker via mDNS (_mqtt._tcp.local)");
+static void on_broker_moved(const struct sockaddr_in *addr)
+{
+    ARG_UNUSED(addr);
+    atomic_set(&broker_moved, 1);
+}
+
+/*
+ * Cached address first, unless mDNS has seen the broker move; then the mDNS
+ * cache, which normally answers at once, and the static fallback.
+ */
+static int resolve_broker(struct sockaddr_in *broker4)
+{
+    if (atomic_clear(&broker_moved) && broker_cached) {
+        LOG_INF("MQTT broker moved, dropping the cached address");
+        broker_cached = false;
+        /* The new broker gets another chance at 5.0 */
+        mqtt_v5 = IS_ENABLED(CONFIG_APP_MQTT_V5);
+    }
+
+    if (broker_cached) {
+        memcpy(broker4, &cached_broker, sizeof(*broker4));
+        broker_source = BROKER_SOURCE_CACHE;
+        return 0;
+    }
 
     struct sockaddr_in mdns_found;
     uint16_t mdns_port = 0;
     memset(&mdns_found, 0, sizeof(mdns_found));
-    ret = mdns_browse_mqtt(&mdns_found, &mdns_port, 10000);
+    int ret = mdns_browse_mqtt(&mdns_found, &mdns_port, MDNS_BROWSE_TIMEOUT_MS);
     if (ret == 0) {
         memcpy(broker4, &mdns_found, sizeof(struct sockaddr_in));
         if (mdns_port != 0) {
             broker4->sin_port = htons(mdns_port);
         }
-    } else if (broker_from_static(broker4) == 0) {
-        ret = 0;
-    } else {
-        LOG_ERR("Unable to resolve MQTT broker via mDNS and no static fallback configured (%d)", ret);
+        broker_source = BROKER_SOURCE_MDNS;
+        return 0;
+    }
+
+    if (broker_from_static(broker4) == 0) {
+        broker_source = BROKER_SOURCE_STATIC;
+        return 0;
+    }
+
+    LOG_ERR("Unable to resolve MQTT broker via mDNS and no static fallback configured (%d)", ret);
+    return ret;
+}
+
+static int mqtt_broker_connect(void)
+{
+    struct sockaddr_in *broker4 = (struct sockaddr_in *)&broker;
+    int ret;
+
+    ret = resolve_broker(broker4);
+    if (ret < 0) {
         return ret;
     }
 
     char addr_str[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &broker4->sin_addr, addr_str, sizeof(addr_str));
-    LOG_INF("MQTT broker resolved at %s:%u", addr_str, ntohs(broker4->sin_port));
+    LOG_INF("MQTT broker at %s:%u (%s, MQTT %s)", addr_str, ntohs(broker4->sin_port),
+            broker_source_name(broker_source), mqtt_v5 ? "5.0" : "3.1.1");
 
     mqtt_client_init(&client_ctx);
 
@@ -149,6 +610,15 @@ static int mqtt_broker_connect(void)
     client_ctx.password = NULL;
     client_ctx.user_name = NULL;
     client_ctx.protocol_version = MQTT_VERSION_3_1_1;
+    /* Persistent session: the broker keeps our subscriptions and queued QoS 1 commands */
+    client_ctx.clean_session = 0;
+#if defined(CONFIG_APP_MQTT_V5)
+    if (mqtt_v5) {
+        client_ctx.protocol_version = MQTT_VERSION_5_0;
+        /* 5.0 ends the session on disconnect unless it is given an expiry */
+        client_ctx.prop.session_expiry_interval = UINT32_MAX;
+    }
+#endif
     client_ctx.rx_buf = rx_buffer;
     client_ctx.rx_buf_size = sizeof(rx_buffer);
     client_ctx.tx_buf = tx_buffer;
@@ -161,8 +631,8 @@ static int mqtt_broker_connect(void)
         return ret;
     }
 
-    fds.fd = client_ctx.transport.tcp.sock;
-    fds.events = POLLIN;
+    fds[POLL_SOCKET].fd = client_ctx.transport.tcp.sock;
+    fds[POLL_SOCKET].events = POLLIN;
 
     LOG_INF("Connected to MQTT broker (TCP established, awaiting CONNACK)");
     return 0;
@@ -170,6 +640,26 @@ static int mqtt_broker_connect(void)
 
 int app_mqtt_init(void)
 {
+    int ret = mqtt_ingress_init();
+    if (ret < 0) {
+        return ret;
+    }
+
+    wake_fd = zvfs_eventfd(0, ZVFS_EFD_NONBLOCK);
+    if (wake_fd < 0) {
+        LOG_WRN("No eventfd for the publish queue (%d), polling every %d ms",
+                errno, PUBLISH_FLUSH_INTERVAL_MS);
+    }
+
+    fds[POLL_WAKE].fd = wake_fd;
+    fds[POLL_WAKE].events = POLLIN;
+
+    mdns_register_broker_change_callback(on_broker_moved);
+    ret = mdns_client_start();
+    if (ret < 0) {
+        return ret;
+    }
+
     LOG_INF("MQTT client initialized");
     return 0;
 }
@@ -182,7 +672,7 @@ static void subscribe_to_topics(void)
         if (subscriptions[i].active) {
             struct mqtt_topic sub_topic = {
                 .topic.utf8 = (uint8_t *)subscriptions[i].topic,
-                .topic.size = strlen(subscriptions[i].topic),
+                .topic.size = subscriptions[i].len,
                 .qos = MQTT_QOS_1_AT_LEAST_ONCE
             };
 
@@ -202,10 +692,472 @@ static void subscribe_to_topics(void)
     }
 }
 
+typedef enum {
+    OFFLINE_DROP,   /* -ENOTCONN while disconnected */
+    OFFLINE_LATEST, /* the newest message is kept and sent after the reconnect */
+    OFFLINE_KEEP,   /* every message is kept in the offline ring, in order */
+} offline_policy_t;
+
+#define OFFLINE_TELEMETRY \
+    (IS_ENABLED(CONFIG_APP_MQTT_OFFLINE_TELEMETRY) ? OFFLINE_LATEST : OFFLINE_DROP)
+
+typedef struct {
+    const char *filter;
+    uint8_t qos;
+    bool retain;
+    uint16_t min_interval_ms; /* 0 = no rate limit; faster publishes are dropped */
+    mqtt_priority_t prio;
+    offline_policy_t offline;
+} publish_policy_t;
+
+/*
+ * Delivery policy per topic, looked up with the subscription filter syntax;
+ * the most specific filter wins. State that the host can always recover
+ * (deltas carry sequence numbers, the keyframe is retained) goes out at
+ * QoS 0; moves, status and request responses are acknowledged. The latest
+ * board state is retained so a new subscriber has it without a ping.
+ * Moves and action results survive a connection loss; request responses
+ * are stale by the time the host could see them.
+ *
+ * The pong is the one response sent at QoS 0: it is a liveness and latency
+ * probe, so a lost pong should show up as a lost ping rather than be
+ * redelivered late with a misleading round trip, and the host pings again
+ * anyway. It still takes the high priority queue.
+ */
+static const publish_policy_t publish_policies[] = {
+    { "chess/board/move",          MQTT_QOS_1_AT_LEAST_ONCE, false, 0,  MQTT_PRIO_HIGH,   OFFLINE_KEEP },
+    { "chess/board/robot_move",    MQTT_QOS_1_AT_LEAST_ONCE, false, 0,  MQTT_PRIO_HIGH,   OFFLINE_KEEP },
+    { "chess/robot/status",        MQTT_QOS_1_AT_LEAST_ONCE, false, 0,  MQTT_PRIO_HIGH,   OFFLINE_KEEP },
+    { "chess/robot/status/bin",    MQTT_QOS_1_AT_LEAST_ONCE, false, 0,  MQTT_PRIO_HIGH,   OFFLINE_KEEP },
+    { "chess/system/pong",         MQTT_QOS_0_AT_MOST_ONCE,  false, 0,  MQTT_PRIO_HIGH,   OFFLINE_DROP },
+    { "chess/board/state",         MQTT_QOS_0_AT_MOST_ONCE,  true,  0,  MQTT_PRIO_NORMAL, OFFLINE_LATEST },
+    { "chess/board/state/bin",     MQTT_QOS_0_AT_MOST_ONCE,  true,  0,  MQTT_PRIO_NORMAL, OFFLINE_LATEST },
+    { "chess/board/fullstate",     MQTT_QOS_0_AT_MOST_ONCE,  true,  0,  MQTT_PRIO_NORMAL, OFFLINE_LATEST },
+    { "chess/board/delta",         MQTT_QOS_0_AT_MOST_ONCE,  false, 0,  MQTT_PRIO_NORMAL, OFFLINE_DROP },
+    { "chess/board/keyframe",      MQTT_QOS_1_AT_LEAST_ONCE, true,  0,  MQTT_PRIO_NORMAL, OFFLINE_LATEST },
+    { "chess/board/health",        MQTT_QOS_0_AT_MOST_ONCE,  false, 0,  MQTT_PRIO_NORMAL, OFFLINE_TELEMETRY },
+    { "chess/robot/position/bin",  MQTT_QOS_0_AT_MOST_ONCE,  false, 50, MQTT_PRIO_NORMAL, OFFLINE_TELEMETRY },
+    { "chess/robot/telemetry/bin", MQTT_QOS_0_AT_MOST_ONCE,  false, 0,  MQTT_PRIO_NORMAL, OFFLINE_DROP },
+    { "#",                         MQTT_QOS_1_AT_LEAST_ONCE, false, 0,  MQTT_PRIO_NORMAL, OFFLINE_DROP },
+};
+
+/* Uptime of the last accepted publish per policy, for the rate limit */
+static atomic_t publish_last_ms[ARRAY_SIZE(publish_policies)];
+
+static int find_publish_policy(const char *topic, size_t len)
+{
+    int best = ARRAY_SIZE(publish_policies) - 1;
+    int best_score = -1;
+
+    for (int i = 0; i < ARRAY_SIZE(publish_policies); i++) {
+        int score = topic_filter_match(publish_policies[i].filter, (const uint8_t *)topic, len);
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+/* Claim the policy's rate-limit slot; false if the last publish was too recent */
+static bool publish_rate_allowed(int policy)
+{
+    uint16_t interval = publish_policies[policy].min_interval_ms;
+
+    if (interval == 0) {
+        return true;
+    }
+
+    uint32_t now = k_uptime_get_32();
+    atomic_val_t last = atomic_get(&publish_last_ms[policy]);
+
+    if (now - (uint32_t)last < interval) {
+        return false;
+    }
+
+    /* Losing the race to another producer counts as too recent */
+    return atomic_cas(&publish_last_ms[policy], last, (atomic_val_t)now);
+}
+
+static void release_publish_msg(publish_msg_t *msg)
+{
+    k_mem_slab_free(msg->slab, msg);
+}
+
+/*
+ * Messages published without a connection. KEEP messages queue up in the
+ * ring, LATEST ones overwrite their policy's slot. While anything is
+ * pending, new KEEP and LATEST messages are held as well, so the replay
+ * after a reconnect stays in publish order.
+ */
+static sys_slist_t offline_ring;
+static uint32_t offline_ring_len;
+static publish_msg_t *offline_latest[ARRAY_SIZE(publish_policies)];
+static uint32_t offline_pending; /* ring plus occupied latest slots */
+static struct k_spinlock offline_lock;
+static atomic_t offline_dropped = ATOMIC_INIT(0);
+
+/* Drop the oldest ring entries beyond the limit; called with offline_lock held */
+static void offline_trim(void)
+{
+    while (offline_ring_len > OFFLINE_QUEUE_MAX) {
+        publish_msg_t *old = CONTAINER_OF(sys_slist_get(&offline_ring), publish_msg_t, node);
+        offline_ring_len--;
+        offline_pending--;
+        atomic_inc(&offline_dropped);
+        release_publish_msg(old);
+    }
+}
+
+/*
+ * The ring shares its slots with everything else queued, so it can use up
+ * a slab before offline_trim() has anything to drop. Give the oldest ring
+ * entry from @p slab up to make room for a new KEEP message.
+ */
+static bool offline_evict_oldest(struct k_mem_slab *slab)
+{
+    publish_msg_t *msg;
+    bool evicted = false;
+
+    k_spinlock_key_t key = k_spin_lock(&offline_lock);
+    SYS_SLIST_FOR_EACH_CONTAINER(&offline_ring, msg, node) {
+        if (msg->slab == slab) {
+            sys_slist_find_and_remove(&offline_ring, &msg->node);
+            offline_ring_len--;
+            offline_pending--;
+            atomic_inc(&offline_dropped);
+            release_publish_msg(msg);
+            evicted = true;
+            break;
+        }
+    }
+    k_spin_unlock(&offline_lock, key);
+
+    return evicted;
+}
+
+/* Keep the message for later if it may not go out now; true if it was taken */
+static bool offline_hold(publish_msg_t *msg)
+{
+    offline_policy_t offline = publish_policies[msg->policy].offline;
+    bool held = false;
+
+    if (offline == OFFLINE_DROP) {
+        return false;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&offline_lock);
+    if (!mqtt_connected || offline_pending > 0) {
+        if (offline == OFFLINE_KEEP) {
+            sys_slist_append(&offline_ring, &msg->node);
+            offline_ring_len++;
+            offline_pending++;
+            offline_trim();
+        } else {
+            publish_msg_t *old = offline_latest[msg->policy];
+            offline_latest[msg->policy] = msg;
+            if (old) {
+                release_publish_msg(old);
+            } else {
+                offline_pending++;
+            }
+        }
+        held = true;
+    }
+    k_spin_unlock(&offline_lock, key);
+
+    return held;
+}
+
+/* Oldest held message, ring first, then the latest-value slots */
+static publish_msg_t *offline_next(void)
+{
+    publish_msg_t *msg = NULL;
+
+    k_spinlock_key_t key = k_spin_lock(&offline_lock);
+    if (offline_pending > 0) {
+        sys_snode_t *node = sys_slist_get(&offline_ring);
+        if (node) {
+            msg = CONTAINER_OF(node, publish_msg_t, node);
+            offline_ring_len--;
+        } else {
+            for (int i = 0; i < ARRAY_SIZE(offline_latest) && !msg; i++) {
+                msg = offline_latest[i];
+                offline_latest[i] = NULL;
+            }
+        }
+        if (msg) {
+            offline_pending--;
+        }
+    }
+    k_spin_unlock(&offline_lock, key);
+
+    return msg;
+}
+
+static int publish_message(const char *topic, const char *payload, uint32_t payload_len,
+                           bool retain, uint32_t correlation_id)
+{
+    struct k_mem_slab *slab;
+    publish_msg_t *msg;
+    size_t topic_len = strlen(topic);
+    int policy = find_publish_policy(topic, topic_len);
+
+    if (!mqtt_connected && publish_policies[policy].offline == OFFLINE_DROP) {
+        return -ENOTCONN;
+    }
+
+    if (topic_len >= PUBLISH_TOPIC_MAX || payload_len > PUBLISH_LARGE_PAYLOAD_MAX) {
+        LOG_ERR("Publish to %s too large (%u bytes)", topic, payload_len);
+        return -EMSGSIZE;
+    }
+
+    if (!publish_rate_allowed(policy)) {
+        LOG_DBG("Rate limit, dropping %s", topic);
+        return -EAGAIN;
+    }
+
+    slab = payload_len <= PUBLISH_SMALL_PAYLOAD_MAX ? &publish_small_slab : &publish_large_slab;
+    if (k_mem_slab_alloc(slab, (void **)&msg, K_NO_WAIT) != 0 &&
+        (publish_policies[policy].offline != OFFLINE_KEEP || !offline_evict_oldest(slab) ||
+         k_mem_slab_alloc(slab, (void **)&msg, K_NO_WAIT) != 0)) {
+        atomic_inc(&publish_dropped);
+        LOG_DBG("Publish queue full, dropping %s", topic);
+        return -ENOBUFS;
+    }
+
+    msg->slab = slab;
+    memcpy(msg->topic, topic, topic_len + 1);
+    memcpy(msg->payload, payload, payload_len);
+    msg->len = payload_len;
+    msg->correlation_id = correlation_id;
+    msg->message_id = 0;
+    msg->policy = (uint8_t)policy;
+    msg->qos = publish_policies[policy].qos;
+    msg->retain = retain || publish_policies[policy].retain;
+
+    if (!offline_hold(msg)) {
+        k_fifo_put(publish_policies[policy].prio == MQTT_PRIO_HIGH ? &publish_queue_high
+                                                                      : &publish_queue, msg);
+    }
+
+    /* Wake the MQTT thread out of poll(); the counter just accumulates */
+    if (wake_fd >= 0) {
+        (void)zvfs_eventfd_write(wake_fd, 1);
+    }
+    return 0;
+}
+
+/* PUBACK for a kept message: it is delivered and the slot can go */
+static void publish_acked(uint16_t message_id)
+{
+    publish_msg_t *msg;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&publish_inflight, msg, node) {
+        if (msg->message_id == message_id) {
+            sys_slist_find_and_remove(&publish_inflight, &msg->node);
+            release_publish_msg(msg);
+            return;
+        }
+    }
+}
+
+/*
+ * After a connection loss, put unacknowledged and still queued KEEP
+ * messages back in front of the offline ring, oldest first, so they are
+ * resent after the reconnect. Queued LATEST messages fill an empty slot;
+ * everything else is dropped.
+ */
+static void requeue_unsent_publishes(void)
+{
+    sys_slist_t requeue;
+    uint32_t requeued = 0;
+    publish_msg_t *msg;
+    sys_snode_t *node;
+
+    sys_slist_init(&requeue);
+    while ((node = sys_slist_get(&publish_inflight)) != NULL) {
+        sys_slist_append(&requeue, node);
+        requeued++;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&offline_lock);
+    for (int i = 0; i < 2; i++) {
+        struct k_fifo *queue = i == 0 ? &publish_queue_high : &publish_queue;
+
+        while ((msg = k_fifo_get(queue, K_NO_WAIT)) != NULL) {
+            offline_policy_t offline = publish_policies[msg->policy].offline;
+
+            if (offline == OFFLINE_KEEP) {
+                sys_slist_append(&requeue, &msg->node);
+                requeued++;
+            } else if (offline == OFFLINE_LATEST && !offline_latest[msg->policy]) {
+                offline_latest[msg->policy] = msg;
+                offline_pending++;
+            } else {
+                release_publish_msg(msg);
+            }
+        }
+    }
+
+    sys_slist_merge_slist(&requeue, &offline_ring);
+    offline_ring = requeue;
+    offline_ring_len += requeued;
+    offline_pending += requeued;
+    offline_trim();
+    k_spin_unlock(&offline_lock, key);
+
+    if (requeued > 0) {
+        LOG_INF("%u unacknowledged messages kept for the reconnect", requeued);
+    }
+}
+
+/* Held messages first, then high priority, checked again before every normal one */
+static publish_msg_t *next_queued_publish(void)
+{
+    publish_msg_t *msg = offline_next();
+
+    if (!msg) {
+        msg = k_fifo_get(&publish_queue_high, K_NO_WAIT);
+    }
+    return msg ? msg : k_fifo_get(&publish_queue, K_NO_WAIT);
+}
+
+/*
+ * Drain the queue on the MQTT thread. A burst is written back to back in
+ * one pass, which lets the TCP stack coalesce the small publishes into
+ * fewer segments.
+ */
+static int send_queued_publishes(void)
+{
+    publish_msg_t *msg;
+    int ret = 0;
+
+    while ((msg = next_queued_publish()) != NULL) {
+        /* A message that already has an id was sent before the reconnect */
+        bool resend = msg->message_id != 0;
+        struct mqtt_publish_param param = {
+            .message.topic.qos = msg->qos,
+            .message.topic.topic.utf8 = (uint8_t *)msg->topic,
+            .message.topic.topic.size = strlen(msg->topic),
+            .message.payload.data = msg->payload,
+            .message.payload.len = msg->len,
+            .message_id = 0,
+            .dup_flag = resend ? 1 : 0,
+            .retain_flag = msg->retain ? 1 : 0,
+        };
+
+#if defined(CONFIG_APP_MQTT_V5)
+        char correlation[11];
+
+        if (mqtt_v5) {
+            set_publish_properties(&param, msg, correlation, sizeof(correlation));
+        }
+#endif
+
+        /* Message id 0 is reserved for QoS 0 */
+        if (msg->qos != MQTT_QOS_0_AT_MOST_ONCE) {
+            if (!resend) {
+                msg->message_id = next_message_id;
+                if (++next_message_id == 0) {
+                    next_message_id = 1;
+                }
+            }
+            param.message_id = msg->message_id;
+        }
+
+        ret = mqtt_publish(&client_ctx, &param);
+        if (ret < 0) {
+            LOG_WRN("Failed to publish %s: %d", msg->topic, ret);
+        }
+
+        /* Kept messages wait for their PUBACK, or for the next connection */
+        if (msg->qos != MQTT_QOS_0_AT_MOST_ONCE &&
+            publish_policies[msg->policy].offline == OFFLINE_KEEP) {
+            sys_slist_append(&publish_inflight, &msg->node);
+        } else {
+            release_publish_msg(msg);
+        }
+
+        if (ret == -ENOTCONN || ret == -EPIPE || ret == -ECONNRESET) {
+            break;
+        }
+    }
+
+    atomic_val_t dropped = atomic_clear(&publish_dropped);
+    if (dropped > 0) {
+        LOG_WRN("Publish queue overflowed, %ld messages dropped", (long)dropped);
+    }
+
+    dropped = atomic_clear(&offline_dropped);
+    if (dropped > 0) {
+        LOG_WRN("Offline queue overflowed, %ld oldest messages dropped", (long)dropped);
+    }
+
+    return ret;
+}
+
+/* Delay before the next connection attempt, doubling per failure */
+static uint32_t next_backoff_ms(uint32_t *backoff_ms)
+{
+    uint32_t base = *backoff_ms;
+    uint32_t delay = base / 2 + sys_rand32_get() % (base / 2 + 1);
+
+    *backoff_ms = MIN(base * 2, RECONNECT_BACKOFF_MAX_MS);
+    return delay;
+}
+
+/* Forget the cached broker so the next attempt rediscovers it */
+static void connect_failed(void)
+{
+    if (broker_source == BROKER_SOURCE_CACHE) {
+        LOG_WRN("Cached MQTT broker unreachable, falling back to mDNS");
+        broker_cached = false;
+    }
+    if (broker_source != BROKER_SOURCE_STATIC) {
+        mdns_flush_mqtt();
+    }
+}
+
+static void publish_online_status(void)
+{
+    char addr_str[INET_ADDRSTRLEN];
+    char buf[192];
+    json_writer_t w;
+
+    inet_ntop(AF_INET, &((struct sockaddr_in *)&broker)->sin_addr, addr_str, sizeof(addr_str));
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_object_begin(&w);
+    jw_field_string(&w, "status", "online");
+    jw_field_uint(&w, "timestamp", k_uptime_get_32());
+    jw_field_string(&w, "broker", addr_str);
+    jw_field_string(&w, "broker_source", broker_source_name(broker_source));
+    jw_field_string(&w, "protocol", mqtt_v5 ? "5.0" : "3.1.1");
+    jw_field_uint(&w, "reconnects", reconnect_count);
+    jw_field_uint(&w, "reconnect_ms", last_reconnect_ms);
+    jw_field_uint(&w, "replaying", offline_pending);
+    jw_object_end(&w);
+
+    int len = jw_finish(&w);
+    if (len < 0) {
+        return;
+    }
+
+    int pr = app_mqtt_publish("chess/system/online", buf, (uint32_t)len);
+    if (pr < 0) {
+        LOG_WRN("Failed to publish online status: %d", pr);
+    } else {
+        LOG_INF("Published online status");
+    }
+}
+
 void mqtt_client_thread(void *p1, void *p2, void *p3)
 {
     int ret;
-    const uint32_t retry_delay_sec = 15;
+    uint32_t backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+    int64_t disconnected_at = -1; /* uptime of the last connection loss */
     bool first_attempt = true;
 
     ARG_UNUSED(p1);
@@ -231,13 +1183,15 @@ void mqtt_client_thread(void *p1, void *p2, void *p3)
             k_sleep(K_SECONDS(5));
             first_attempt = false;
         } else {
-            LOG_INF("Retrying connection in %u seconds...", retry_delay_sec);
-            k_sleep(K_SECONDS(retry_delay_sec));
+            uint32_t delay = next_backoff_ms(&backoff_ms);
+            LOG_INF("Retrying connection in %u ms...", delay);
+            k_sleep(K_MSEC(delay));
         }
 
         ret = mqtt_broker_connect();
         if (ret < 0) {
             LOG_ERR("Failed to connect to broker, will retry");
+            connect_failed();
             continue;
         }
 
@@ -246,7 +1200,7 @@ void mqtt_client_thread(void *p1, void *p2, void *p3)
             uint32_t deadline = k_uptime_get_32() + 5000; /* 5s */
             while (!mqtt_connected && (int32_t)(deadline - (int32_t)k_uptime_get_32()) > 0) {
                 int wait = 100;
-                int pr = poll(&fds, 1, wait);
+                int pr = poll(&fds[POLL_SOCKET], 1, wait);
                 if (pr < 0) {
                     LOG_ERR("Poll error while waiting CONNACK: %d", errno);
                     break;
@@ -258,39 +1212,56 @@ void mqtt_client_thread(void *p1, void *p2, void *p3)
         if (!mqtt_connected) {
             LOG_ERR("Timed out waiting for MQTT CONNACK");
             (void)mqtt_disconnect(&client_ctx, 0);
+            connect_failed();
             continue;
         }
 
         LOG_INF("MQTT connection established (CONNACK received)");
 
+        memcpy(&cached_broker, &broker, sizeof(cached_broker));
+        broker_cached = true;
+        backoff_ms = RECONNECT_BACKOFF_MIN_MS;
+
+        if (disconnected_at >= 0) {
+            reconnect_count++;
+            last_reconnect_ms = (uint32_t)(k_uptime_get() - disconnected_at);
+            LOG_INF("Reconnected after %u ms", last_reconnect_ms);
+        }
+
         // Subscribe to all registered topics now that we're connected
         subscribe_to_topics();
 
         /* Publish online status to help verify connectivity */
-        {
-            char buf[96];
-            int len = snprintk(buf, sizeof(buf), "{\"status\":\"online\",\"timestamp\":%u}", k_uptime_get_32());
-            if (len > 0) {
-                int pr = app_mqtt_publish("chess/system/online", buf, (uint32_t)len);
-                if (pr < 0) {
-                    LOG_WRN("Failed to publish online status: %d", pr);
-                } else {
-                    LOG_INF("Published online status");
-                }
-            }
-        }
+        publish_online_status();
 
         // Main MQTT processing loop
         while (mqtt_connected) {
-            ret = poll(&fds, 1, mqtt_keepalive_time_left(&client_ctx));
+            ret = send_queued_publishes();
+            if (ret == -ENOTCONN || ret == -EPIPE || ret == -ECONNRESET) {
+                break;
+            }
+
+            int timeout = mqtt_keepalive_time_left(&client_ctx);
+            if (wake_fd < 0) {
+                timeout = MIN(timeout, PUBLISH_FLUSH_INTERVAL_MS);
+            }
+
+            ret = poll(fds, wake_fd >= 0 ? 2 : 1, timeout);
             if (ret < 0) {
                 LOG_ERR("Poll error: %d", errno);
                 break;
             }
 
-            mqtt_input(&client_ctx);
+            if (wake_fd >= 0 && (fds[POLL_WAKE].revents & POLLIN)) {
+                zvfs_eventfd_t count;
+                (void)zvfs_eventfd_read(wake_fd, &count);
+            }
 
-            if ((fds.revents & POLLERR) || (fds.revents & POLLNVAL)) {
+            if (fds[POLL_SOCKET].revents & POLLIN) {
+                mqtt_input(&client_ctx);
+            }
+
+            if (fds[POLL_SOCKET].revents & (POLLERR | POLLHUP | POLLNVAL)) {
                 LOG_ERR("Socket error");
                 break;
             }
@@ -300,37 +1271,39 @@ void mqtt_client_thread(void *p1, void *p2, void *p3)
                 LOG_ERR("MQTT live error: %d", ret);
                 break;
             }
-
-            k_sleep(K_MSEC(100));
         }
 
         LOG_WRN("MQTT connection lost, attempting to reconnect");
         (void)mqtt_disconnect(&client_ctx, 0);
         mqtt_connected = false;
+        requeue_unsent_publishes();
+        disconnected_at = k_uptime_get();
     }
 }
 
 int app_mqtt_publish(const char *topic, const char *payload, uint32_t payload_len)
 {
-    struct mqtt_publish_param param;
-
-    if (!mqtt_connected) {
-        return -ENOTCONN;
-    }
+    return publish_message(topic, payload, payload_len, false, 0);
+}
 
-    param.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE;
-    param.message.topic.topic.utf8 = (uint8_t *)topic;
-    param.message.topic.topic.size = strlen(topic);
-    param.message.payload.data = (uint8_t *)payload;
-    param.message.payload.len = payload_len;
-    param.message_id = sys_rand32_get();
-    param.dup_flag = 0;
-    param.retain_flag = 0;
+int app_mqtt_publish_retained(const char *topic, const char *payload, uint32_t payload_len)
+{
+    return publish_message(topic, payload, payload_len, true, 0);
+}
 
-    return mqtt_publish(&client_ctx, &param);
+int app_mqtt_publish_correlated(const char *topic, const char *payload, uint32_t payload_len,
+                                uint32_t correlation_id)
+{
+    return publish_message(topic, payload, payload_len, false, correlation_id);
 }
 
 int app_mqtt_subscribe(const char *topic, mqtt_message_callback_t callback)
+{
+    return app_mqtt_subscribe_priority(topic, callback, MQTT_PRIO_NORMAL);
+}
+
+int app_mqtt_subscribe_priority(const char *topic, mqtt_message_callback_t callback,
+                                mqtt_priority_t prio)
 {
     int slot = -1;
 
@@ -346,14 +1319,24 @@ int app_mqtt_subscribe(const char *topic, mqtt_message_callback_t callback)
         return -ENOMEM;
     }
 
-    strncpy(subscriptions[slot].topic, topic, sizeof(subscriptions[slot].topic) - 1);
+    size_t len = strlen(topic);
+    if (len >= SUB_TOPIC_MAX) {
+        LOG_ERR("Topic filter too long: %s", topic);
+        return -EINVAL;
+    }
+
+    memcpy(subscriptions[slot].topic, topic, len + 1);
+    subscriptions[slot].len = (uint16_t)len;
+    subscriptions[slot].hash = topic_hash((const uint8_t *)topic, len);
+    subscriptions[slot].wildcard = strpbrk(topic, "+#") != NULL;
+    subscriptions[slot].prio = prio;
     subscriptions[slot].callback = callback;
     subscriptions[slot].active = true;
 
     if (mqtt_connected) {
         struct mqtt_topic sub_topic = {
             .topic.utf8 = (uint8_t *)subscriptions[slot].topic,
-            .topic.size = strlen(subscriptions[slot].topic),
+            .topic.size = subscriptions[slot].len,
             .qos = MQTT_QOS_1_AT_LEAST_ONCE
         };
 
@@ -373,6 +1356,10 @@ int app_mqtt_subscribe(const char *topic, mqtt_message_callback_t callback)
         LOG_INF("Subscribed to %s", topic);
     }
 
+    if (!subscriptions[slot].wildcard) {
+        sub_index_insert(slot);
+    }
+
     return 0;
 }
 
@@ -0,0 +1,163 @@
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/buf.h>
+#include <string.h>
+#include "mqtt_ingress.h"
+#include "app_config.h"
+#include "json_arena.h"
+
+LOG_MODULE_REGISTER(mqtt_ingress, LOG_LEVEL_INF);
+
+#define INGRESS_STACK_SIZE 4096
+#define INGRESS_TOPIC_MAX  64
+
+/*
+ * High priority messages (stop, ping) are small and get a fixed pool of
+ * their own, so a queue full of large moves cannot starve them of either
+ * buffers or bytes. The variable pool takes normal messages, and high
+ * priority ones only when they do not fit the reserve. It holds two
+ * maximum size payloads; sys_heap adds a chunk header to each allocation
+ * and keeps some bookkeeping of its own, hence the slack.
+ */
+#define INGRESS_PAYLOAD_MAX       CONFIG_APP_MQTT_RX_PAYLOAD_MAX
+#define INGRESS_BUFS              6
+#define INGRESS_HIGH_RESERVE      2
+#define INGRESS_HIGH_RESERVE_SIZE 256
+#define INGRESS_CHUNK_OVERHEAD    16
+#define INGRESS_HEAP_OVERHEAD     128
+#define INGRESS_POOL_BYTES        (2 * (INGRESS_PAYLOAD_MAX + 1 + INGRESS_CHUNK_OVERHEAD) + \
+                                   INGRESS_HEAP_OVERHEAD)
+
+typedef struct {
+    mqtt_message_callback_t callback;
+    int64_t rx_us;
+    uint32_t correlation_id;
+    uint8_t prio;
+    char topic[INGRESS_TOPIC_MAX];
+} ingress_meta_t;
+
+NET_BUF_POOL_VAR_DEFINE(ingress_pool, INGRESS_BUFS, INGRESS_POOL_BYTES,
+                        sizeof(ingress_meta_t), NULL);
+NET_BUF_POOL_FIXED_DEFINE(ingress_high_pool, INGRESS_HIGH_RESERVE, INGRESS_HIGH_RESERVE_SIZE,
+                          sizeof(ingress_meta_t), NULL);
+
+static K_FIFO_DEFINE(ingress_high);
+static K_FIFO_DEFINE(ingress_normal);
+static K_SEM_DEFINE(ingress_pending, 0, INGRESS_BUFS + INGRESS_HIGH_RESERVE);
+
+static K_THREAD_STACK_DEFINE(ingress_stack, INGRESS_STACK_SIZE);
+static struct k_thread ingress_thread;
+
+/* cJSON allocations of the subscriber callbacks, dropped after each message */
+JSON_ARENA_DEFINE(ingress_json_arena, CONFIG_APP_JSON_ARENA_SIZE);
+
+/* Receive time and correlation id of the message whose callback is running */
+static int64_t current_rx_us;
+static uint32_t current_correlation_id;
+
+struct net_buf *mqtt_ingress_alloc(uint32_t len, mqtt_priority_t prio)
+{
+    struct net_buf *buf = NULL;
+
+    if (len > INGRESS_PAYLOAD_MAX) {
+        return NULL;
+    }
+
+    /* One spare byte so the payload is also a valid C string */
+    if (prio == MQTT_PRIO_HIGH && len + 1 <= INGRESS_HIGH_RESERVE_SIZE) {
+        buf = net_buf_alloc_len(&ingress_high_pool, len + 1, K_NO_WAIT);
+    }
+    if (!buf) {
+        buf = net_buf_alloc_len(&ingress_pool, len + 1, K_NO_WAIT);
+    }
+    if (!buf) {
+        return NULL;
+    }
+
+    ingress_meta_t *meta = net_buf_user_data(buf);
+    meta->prio = (uint8_t)prio;
+    meta->rx_us = (int64_t)k_ticks_to_us_floor64(k_uptime_ticks());
+    return buf;
+}
+
+int mqtt_ingress_submit(struct net_buf *buf, const uint8_t *topic, size_t topic_len,
+                        mqtt_message_callback_t callback, mqtt_priority_t prio,
+                        uint32_t correlation_id)
+{
+    ingress_meta_t *meta = net_buf_user_data(buf);
+
+    if (topic_len >= sizeof(meta->topic)) {
+        LOG_WRN("Incoming topic too long (%u bytes), dropped", (unsigned int)topic_len);
+        net_buf_unref(buf);
+        return -EMSGSIZE;
+    }
+
+    memcpy(meta->topic, topic, topic_len);
+    meta->topic[topic_len] = '\0';
+    meta->callback = callback;
+    meta->correlation_id = correlation_id;
+
+    k_fifo_put(prio == MQTT_PRIO_HIGH ? &ingress_high : &ingress_normal, buf);
+    k_sem_give(&ingress_pending);
+    return 0;
+}
+
+static void ingress_worker(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    if (json_arena_attach(&ingress_json_arena) < 0) {
+        LOG_WRN("No JSON arena, handlers parse on the heap");
+    }
+
+    while (1) {
+        k_sem_take(&ingress_pending, K_FOREVER);
+
+        /* One semaphore count per queued buffer, high priority first */
+        struct net_buf *buf = k_fifo_get(&ingress_high, K_NO_WAIT);
+        if (!buf) {
+            buf = k_fifo_get(&ingress_normal, K_NO_WAIT);
+        }
+        if (!buf) {
+            continue;
+        }
+
+        const ingress_meta_t *meta = net_buf_user_data(buf);
+        if (meta->callback) {
+            current_rx_us = meta->rx_us;
+            current_correlation_id = meta->correlation_id;
+            meta->callback(meta->topic, buf->data, buf->len);
+            json_arena_reset(&ingress_json_arena);
+        }
+
+        net_buf_unref(buf);
+    }
+}
+
+uint32_t mqtt_ingress_queued(void)
+{
+    return k_sem_count_get(&ingress_pending);
+}
+
+int64_t app_mqtt_rx_time_us(void)
+{
+    return current_rx_us;
+}
+
+uint32_t app_mqtt_rx_correlation_id(void)
+{
+    return current_correlation_id;
+}
+
+int mqtt_ingress_init(void)
+{
+    k_thread_create(&ingress_thread, ingress_stack,
+                    K_THREAD_STACK_SIZEOF(ingress_stack),
+                    ingress_worker, NULL, NULL, NULL,
+                    THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&ingress_thread, "mqtt_ingress");
+
+    return 0;
+}
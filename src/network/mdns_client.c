@@ -8,6 +8,7 @@
 #include <zephyr/net/socket.h>
 #include <zephyr/net/net_ip.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/zvfs/eventfd.h>
 
 #include "mdns_client.h"
 
@@ -16,6 +17,55 @@ LOG_MODULE_DECLARE(mqtt_client);
 #define MDNS_GROUP_ADDR 0xE00000FB /* 224.0.0.251 */
 #define MDNS_PORT       5353
 
+#define MDNS_SERVICE    "_mqtt._tcp.local"
+
+#define DNS_TYPE_A      1
+#define DNS_TYPE_PTR    12
+#define DNS_TYPE_SRV    33
+
+/*
+ * The listener re-queries a record once 80% of its TTL has passed (RFC 6762
+ * section 5.2), so a valid answer is normally always in the cache. While
+ * nothing is known it retries with a doubling interval.
+ */
+#define MDNS_REFRESH_PERCENT    80
+#define MDNS_RETRY_MIN_MS       1000
+#define MDNS_RETRY_MAX_MS       60000
+#define MDNS_MIN_TTL_S          10
+#define MDNS_LISTENER_STACK     2048
+
+struct mdns_record_time {
+    int64_t expiry;  /* uptime in ms, 0 = not known */
+    int64_t refresh; /* next re-query */
+    uint32_t ttl_ms;
+};
+
+/* One cached record set for the first _mqtt._tcp instance seen */
+struct mdns_cache {
+    char instance[160];
+    struct mdns_record_time ptr;
+    char target[128];
+    uint16_t port;
+    struct mdns_record_time srv;
+    struct in_addr addr;
+    struct mdns_record_time a;
+};
+
+static struct mdns_cache cache;
+static K_MUTEX_DEFINE(cache_lock);
+static K_CONDVAR_DEFINE(cache_changed);
+static mdns_broker_change_callback_t change_callback;
+static int wake_fd = -1;
+
+/* The MQTT client holds the other eventfd */
+BUILD_ASSERT(CONFIG_ZVFS_EVENTFD_MAX >= 2, "mDNS wakeup needs its own eventfd");
+
+static K_THREAD_STACK_DEFINE(mdns_listener_stack, MDNS_LISTENER_STACK);
+static struct k_thread mdns_listener_thread;
+
+/* Only touched by the listener thread */
+static uint8_t rx_buf[768];
+
 struct __packed dns_hdr {
     uint16_t id;
     uint16_t flags;
@@ -99,7 +149,7 @@ static int mdns_decode_name(const uint8_t *msg, size_t msglen, size_t *off_io,
     return -EINVAL;
 }
 
-static int mdns_send_ptr_query(int sock)
+static int mdns_send_query(int sock, const char *name, uint16_t qtype)
 {
     uint8_t buf[512];
     struct dns_hdr *hdr = (struct dns_hdr *)buf;
@@ -107,8 +157,7 @@ static int mdns_send_ptr_query(int sock)
     hdr->qdcount = htons(1);
 
     size_t off = sizeof(struct dns_hdr);
-    const char *svc = "_mqtt._tcp.local";
-    size_t nsz = mdns_encode_qname(&buf[off], sizeof(buf) - off, svc);
+    size_t nsz = mdns_encode_qname(&buf[off], sizeof(buf) - off, name);
     if (!nsz) {
         return -EINVAL;
     }
@@ -116,8 +165,8 @@ static int mdns_send_ptr_query(int sock)
     if (off + 4 > sizeof(buf)) {
         return -EINVAL;
     }
-    buf[off++] = 0;
-    buf[off++] = 12; /* PTR */
+    buf[off++] = (uint8_t)((qtype >> 8) & 0xFF);
+    buf[off++] = (uint8_t)(qtype & 0xFF);
     uint16_t qclass = htons(0x8000 | 1);
     memcpy(&buf[off], &qclass, 2);
     off += 2;
@@ -131,38 +180,223 @@ static int mdns_send_ptr_query(int sock)
     return sendto(sock, buf, off, 0, (struct sockaddr *)&dst, sizeof(dst));
 }
 
-static int mdns_send_query(int sock, const char *name, uint16_t qtype)
+/* ============================================================================
+ * Record cache
+ * ============================================================================ */
+
+static void record_set(struct mdns_record_time *t, uint32_t ttl_s, int64_t now)
 {
-    uint8_t buf[512];
-    struct dns_hdr *hdr = (struct dns_hdr *)buf;
-    memset(buf, 0, sizeof(buf));
-    hdr->qdcount = htons(1);
+    if (ttl_s == 0) {
+        /* Goodbye packet: the record is withdrawn */
+        memset(t, 0, sizeof(*t));
+        return;
+    }
+
+    t->ttl_ms = MAX(ttl_s, MDNS_MIN_TTL_S) * MSEC_PER_SEC;
+    t->expiry = now + t->ttl_ms;
+    t->refresh = now + (int64_t)t->ttl_ms * MDNS_REFRESH_PERCENT / 100;
+}
+
+static bool record_valid(const struct mdns_record_time *t, int64_t now)
+{
+    return t->expiry > now;
+}
+
+static bool record_due(const struct mdns_record_time *t, int64_t now)
+{
+    return !record_valid(t, now) || now >= t->refresh;
+}
+
+/* Next refresh attempt at +5% of the TTL (85%, 90%, 95%) */
+static void record_queried(struct mdns_record_time *t, int64_t now)
+{
+    if (record_valid(t, now)) {
+        t->refresh = now + (int64_t)t->ttl_ms * 5 / 100;
+    }
+}
 
+static uint32_t read_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/*
+ * Walk the resource records of one response. PTR and SRV records are taken
+ * in the first pass and A records in the second, so an address listed
+ * before its SRV record in the same packet is still matched.
+ */
+static bool mdns_apply_records(const uint8_t *buf, size_t len, bool addresses, int64_t now,
+                               bool *moved)
+{
+    const struct dns_hdr *hdr = (const struct dns_hdr *)buf;
     size_t off = sizeof(struct dns_hdr);
-    size_t nsz = mdns_encode_qname(&buf[off], sizeof(buf) - off, name);
-    if (!nsz) {
-        return -EINVAL;
+    uint16_t qd = ntohs(hdr->qdcount);
+    uint16_t total = ntohs(hdr->ancount) + ntohs(hdr->nscount) + ntohs(hdr->arcount);
+    bool changed = false;
+
+    for (uint16_t i = 0; i < qd; i++) {
+        if (mdns_decode_name(buf, len, &off, NULL, 0) < 0 || off + 4 > len) {
+            return false;
+        }
+        off += 4;
     }
-    off += nsz;
-    if (off + 4 > sizeof(buf)) {
-        return -EINVAL;
+
+    for (uint16_t i = 0; i < total && off + 10 <= len; i++) {
+        char rrname[128];
+        if (mdns_decode_name(buf, len, &off, rrname, sizeof(rrname)) < 0 || off + 10 > len) {
+            break;
+        }
+        uint16_t type = (buf[off] << 8) | buf[off + 1];
+        uint32_t ttl = read_be32(&buf[off + 4]);
+        uint16_t rdlen = (buf[off + 8] << 8) | buf[off + 9];
+        off += 10;
+        if (off + rdlen > len) {
+            break;
+        }
+        LOG_DBG("mDNS: RR name=%s type=%u ttl=%u rdlen=%u", rrname, type, ttl, rdlen);
+
+        if (!addresses && type == DNS_TYPE_PTR && strcasecmp(rrname, MDNS_SERVICE) == 0) {
+            size_t off2 = off;
+            char inst[sizeof(cache.instance)];
+            if (mdns_decode_name(buf, len, &off2, inst, sizeof(inst)) == 0) {
+                /* Stick with one instance while it is alive */
+                if (cache.instance[0] == '\0' || !record_valid(&cache.ptr, now) ||
+                    strcasecmp(cache.instance, inst) == 0) {
+                    if (strcasecmp(cache.instance, inst) != 0) {
+                        LOG_INF("mDNS: PTR instance %s", inst);
+                        strncpy(cache.instance, inst, sizeof(cache.instance) - 1);
+                        memset(&cache.srv, 0, sizeof(cache.srv));
+                    }
+                    record_set(&cache.ptr, ttl, now);
+                    changed = true;
+                }
+            }
+        } else if (!addresses && type == DNS_TYPE_SRV && rdlen >= 6 &&
+                   cache.instance[0] && strcasecmp(rrname, cache.instance) == 0) {
+            uint16_t port = (buf[off + 4] << 8) | buf[off + 5];
+            size_t off2 = off + 6;
+            char target[sizeof(cache.target)];
+            if (mdns_decode_name(buf, len, &off2, target, sizeof(target)) == 0) {
+                if (strcasecmp(cache.target, target) != 0) {
+                    LOG_INF("mDNS: SRV %s port %u", target, port);
+                    strncpy(cache.target, target, sizeof(cache.target) - 1);
+                    memset(&cache.a, 0, sizeof(cache.a));
+                }
+                if (cache.port != 0 && cache.port != port) {
+                    *moved = true;
+                }
+                cache.port = port;
+                record_set(&cache.srv, ttl, now);
+                changed = true;
+            }
+        } else if (addresses && type == DNS_TYPE_A && rdlen == 4 &&
+                   cache.target[0] && strcasecmp(rrname, cache.target) == 0) {
+            struct in_addr addr;
+            memcpy(&addr, &buf[off], 4);
+            if (addr.s_addr != cache.addr.s_addr) {
+                char ipbuf[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &addr, ipbuf, sizeof(ipbuf));
+                LOG_INF("mDNS: A %s -> %s", cache.target, ipbuf);
+                if (cache.addr.s_addr != 0) {
+                    *moved = true;
+                }
+                cache.addr = addr;
+            }
+            record_set(&cache.a, ttl, now);
+            changed = true;
+        }
+        off += rdlen;
     }
-    buf[off++] = (uint8_t)((qtype >> 8) & 0xFF);
-    buf[off++] = (uint8_t)(qtype & 0xFF);
-    uint16_t qclass = htons(0x8000 | 1);
-    memcpy(&buf[off], &qclass, 2);
-    off += 2;
 
-    struct sockaddr_in dst = {
-        .sin_family = AF_INET,
-        .sin_port = htons(MDNS_PORT),
-        .sin_addr.s_addr = htonl(MDNS_GROUP_ADDR)
-    };
+    return changed;
+}
 
-    return sendto(sock, buf, off, 0, (struct sockaddr *)&dst, sizeof(dst));
+static void mdns_handle_response(const uint8_t *buf, size_t len)
+{
+    int64_t now = k_uptime_get();
+    bool moved = false;
+    struct sockaddr_in addr;
+    uint16_t port;
+
+    if (len <= sizeof(struct dns_hdr)) {
+        return;
+    }
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    bool changed = mdns_apply_records(buf, len, false, now, &moved);
+    changed |= mdns_apply_records(buf, len, true, now, &moved);
+    if (changed) {
+        k_condvar_broadcast(&cache_changed);
+    }
+    k_mutex_unlock(&cache_lock);
+
+    if (moved && change_callback && mdns_lookup_mqtt(&addr, &port) == 0) {
+        char ipbuf[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &addr.sin_addr, ipbuf, sizeof(ipbuf));
+        LOG_WRN("mDNS: MQTT broker moved to %s:%u", ipbuf, port);
+        change_callback(&addr);
+    }
 }
 
-int mdns_browse_mqtt(struct sockaddr_in *out_addr, uint16_t *out_port, int timeout_ms)
+/*
+ * Send whatever the cache needs: the PTR query while no instance is known,
+ * then SRV and A for the next link of the chain, plus refreshes of records
+ * close to expiry. Returns the time until the next round is due.
+ */
+static int64_t mdns_send_due_queries(int sock, int64_t now, uint32_t *retry_ms)
+{
+    char instance[sizeof(cache.instance)];
+    char target[sizeof(cache.target)];
+    bool ptr_due, srv_due, a_due, complete;
+    int64_t next;
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    ptr_due = record_due(&cache.ptr, now);
+    srv_due = cache.instance[0] && record_due(&cache.srv, now);
+    a_due = cache.target[0] && record_valid(&cache.srv, now) && record_due(&cache.a, now);
+    complete = record_valid(&cache.ptr, now) && record_valid(&cache.srv, now) &&
+               record_valid(&cache.a, now);
+    strcpy(instance, cache.instance);
+    strcpy(target, cache.target);
+
+    if (ptr_due) {
+        record_queried(&cache.ptr, now);
+    }
+    if (srv_due) {
+        record_queried(&cache.srv, now);
+    }
+    if (a_due) {
+        record_queried(&cache.a, now);
+    }
+
+    next = MIN(MIN(cache.ptr.refresh, cache.srv.refresh), cache.a.refresh);
+    k_mutex_unlock(&cache_lock);
+
+    if (ptr_due) {
+        (void)mdns_send_query(sock, MDNS_SERVICE, DNS_TYPE_PTR);
+    }
+    if (srv_due) {
+        (void)mdns_send_query(sock, instance, DNS_TYPE_SRV);
+    }
+    if (a_due) {
+        (void)mdns_send_query(sock, target, DNS_TYPE_A);
+    }
+
+    if (!complete) {
+        int64_t delay = *retry_ms;
+        *retry_ms = MIN(*retry_ms * 2, MDNS_RETRY_MAX_MS);
+        return delay;
+    }
+
+    *retry_ms = MDNS_RETRY_MIN_MS;
+    return MAX(next - now, (int64_t)MDNS_RETRY_MIN_MS);
+}
+
+/* ============================================================================
+ * Listener thread
+ * ============================================================================ */
+
+static int mdns_open_socket(void)
 {
     int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     if (s < 0) {
@@ -184,6 +418,10 @@ int mdns_browse_mqtt(struct sockaddr_in *out_addr, uint16_t *out_port, int timeo
     struct in_addr ifaddr = { .s_addr = htonl(INADDR_ANY) };
     (void)setsockopt(s, IPPROTO_IP, IP_MULTICAST_IF, &ifaddr, sizeof(ifaddr));
 
+    /*
+     * The mDNS responder owns port 5353, so queries go out from an
+     * ephemeral port and responders answer them by unicast.
+     */
     struct sockaddr_in local = {
         .sin_family = AF_INET,
         .sin_port = htons(0),
@@ -196,133 +434,151 @@ int mdns_browse_mqtt(struct sockaddr_in *out_addr, uint16_t *out_port, int timeo
         return err;
     }
 
-    int ret = mdns_send_ptr_query(s);
-    if (ret < 0) {
-        LOG_INF("mDNS: send query failed: %d", ret);
-        close(s);
-        return ret;
-    }
-    LOG_INF("mDNS: PTR query for _mqtt._tcp.local sent (bytes=%d)", ret);
-
-    char target_host[128] = {0};
-    uint16_t target_port = 0;
-    char a_for[128] = {0};
-    struct in_addr a_addr = {0};
-    char instance_name[160] = {0};
-    struct pollfd p = { .fd = s, .events = POLLIN };
-    int deadline = k_uptime_get_32() + timeout_ms;
-
-    while ((int32_t)(deadline - (int32_t)k_uptime_get_32()) > 0) {
-        int wait = deadline - (int32_t)k_uptime_get_32();
-        if (wait < 0) {
-            wait = 0;
-        }
-        ret = poll(&p, 1, wait);
-        if (ret <= 0) {
-            break;
-        }
-        if (p.revents & POLLIN) {
-            uint8_t buf[768];
-            int len = recv(s, buf, sizeof(buf), 0);
-            if (len <= (int)sizeof(struct dns_hdr)) {
+    return s;
+}
+
+static void mdns_listener(void *p1, void *p2, void *p3)
+{
+    int sock = -1;
+    uint32_t retry_ms = MDNS_RETRY_MIN_MS;
+    int64_t next_query = 0;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        if (sock < 0) {
+            sock = mdns_open_socket();
+            if (sock < 0) {
+                k_sleep(K_SECONDS(2));
                 continue;
             }
+            next_query = 0;
+        }
 
-            struct dns_hdr *hdr = (struct dns_hdr *)buf;
-            size_t off = sizeof(struct dns_hdr);
-            uint16_t qd = ntohs(hdr->qdcount);
-            uint16_t an = ntohs(hdr->ancount);
-            uint16_t ns = ntohs(hdr->nscount);
-            uint16_t ar = ntohs(hdr->arcount);
-            LOG_INF("mDNS: received message qd=%u an=%u ns=%u ar=%u", qd, an, ns, ar);
-
-            for (uint16_t i = 0; i < qd; i++) {
-                if (mdns_decode_name(buf, len, &off, NULL, 0) < 0) {
-                    off = len;
-                    break;
-                }
-                if (off + 4 > (size_t)len) {
-                    off = len;
-                    break;
-                }
-                off += 4;
-            }
+        int64_t now = k_uptime_get();
+        if (now >= next_query) {
+            next_query = now + mdns_send_due_queries(sock, now, &retry_ms);
+        }
 
-            uint16_t total = an + ns + ar;
-            for (uint16_t i = 0; i < total && off + 10 <= (size_t)len; i++) {
-                char rrname[128];
-                if (mdns_decode_name(buf, len, &off, rrname, sizeof(rrname)) < 0) {
-                    break;
-                }
-                if (off + 10 > (size_t)len) {
-                    break;
-                }
-                uint16_t type = (buf[off] << 8) | buf[off + 1];
-                uint16_t rdlen = (buf[off + 8] << 8) | buf[off + 9];
-                off += 10;
-                if (off + rdlen > (size_t)len) {
-                    break;
-                }
-                LOG_DBG("mDNS: RR name=%s type=%u rdlen=%u", rrname, type, rdlen);
-
-                if (type == 12) {
-                    size_t off2 = off;
-                    char inst[160];
-                    if (mdns_decode_name(buf, len, &off2, inst, sizeof(inst)) == 0) {
-                        if (strncasecmp(rrname, "_mqtt._tcp.local", sizeof(rrname)) == 0) {
-                            if (instance_name[0] == '\0') {
-                                strncpy(instance_name, inst, sizeof(instance_name) - 1);
-                                LOG_INF("mDNS: PTR instance %s", instance_name);
-                            }
-                        }
-                    }
-                }
-                if (type == 33 && rdlen >= 6) {
-                    uint16_t port = (buf[off + 4] << 8) | buf[off + 5];
-                    size_t off2 = off + 6;
-                    char target[128];
-                    if (mdns_decode_name(buf, len, &off2, target, sizeof(target)) == 0) {
-                        strncpy(target_host, target, sizeof(target_host) - 1);
-                        target_port = port;
-                        LOG_INF("mDNS: SRV %s port %u", target_host, target_port);
-                    }
-                } else if (type == 1 && rdlen == 4) {
-                    if (target_host[0] == '\0' || strcmp(rrname, target_host) == 0) {
-                        memcpy(&a_addr, &buf[off], 4);
-                        strncpy(a_for, rrname, sizeof(a_for) - 1);
-                        char ipbuf[INET_ADDRSTRLEN];
-                        inet_ntop(AF_INET, &a_addr, ipbuf, sizeof(ipbuf));
-                        LOG_INF("mDNS: A %s -> %s", a_for, ipbuf);
-                    }
-                }
-                off += rdlen;
-            }
+        struct pollfd fds[2] = {
+            { .fd = sock, .events = POLLIN },
+            { .fd = wake_fd, .events = POLLIN },
+        };
+        int wait = (int)MAX(next_query - k_uptime_get(), 0);
 
-            if (target_host[0] && a_for[0] && strcmp(target_host, a_for) == 0 &&
-                a_addr.s_addr != 0 && target_port != 0) {
-                out_addr->sin_family = AF_INET;
-                out_addr->sin_addr = a_addr;
-                out_addr->sin_port = htons(target_port);
-                *out_port = target_port;
-                close(s);
-                return 0;
-            }
+        if (poll(fds, wake_fd >= 0 ? 2 : 1, wait) < 0) {
+            LOG_WRN("mDNS: poll failed: %d", errno);
+            close(sock);
+            sock = -1;
+            continue;
+        }
 
-            if (instance_name[0] && target_host[0] == 0) {
-                int rs = mdns_send_query(s, instance_name, 33);
-                if (rs >= 0) {
-                    LOG_INF("mDNS: sent SRV query for %s (bytes=%d)", instance_name, rs);
-                }
-            }
-            if (target_host[0] && a_addr.s_addr == 0) {
-                int ra = mdns_send_query(s, target_host, 1);
-                if (ra >= 0) {
-                    LOG_INF("mDNS: sent A query for %s (bytes=%d)", target_host, ra);
+        if (wake_fd >= 0 && (fds[1].revents & POLLIN)) {
+            zvfs_eventfd_t count;
+            (void)zvfs_eventfd_read(wake_fd, &count);
+            /* Someone is waiting for an answer: query now, from the start of the backoff */
+            retry_ms = MDNS_RETRY_MIN_MS;
+            next_query = 0;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int len = recv(sock, rx_buf, sizeof(rx_buf), 0);
+            if (len > 0) {
+                k_mutex_lock(&cache_lock, K_FOREVER);
+                bool was_complete = record_valid(&cache.a, k_uptime_get());
+                k_mutex_unlock(&cache_lock);
+
+                mdns_handle_response(rx_buf, len);
+
+                /* A PTR or SRV answer lets the next query of the chain go out at once */
+                if (!was_complete) {
+                    next_query = 0;
                 }
             }
         }
     }
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+int mdns_client_start(void)
+{
+    wake_fd = zvfs_eventfd(0, ZVFS_EFD_NONBLOCK);
+    if (wake_fd < 0) {
+        LOG_WRN("mDNS: no eventfd (%d), lookups wait for the next query round", errno);
+    }
+
+    k_thread_create(&mdns_listener_thread, mdns_listener_stack,
+                    K_THREAD_STACK_SIZEOF(mdns_listener_stack),
+                    mdns_listener, NULL, NULL, NULL,
+                    K_PRIO_PREEMPT(7), 0, K_NO_WAIT);
+    k_thread_name_set(&mdns_listener_thread, "mdns_listener");
+
+    return 0;
+}
+
+int mdns_lookup_mqtt(struct sockaddr_in *out_addr, uint16_t *out_port)
+{
+    int64_t now = k_uptime_get();
+    int ret = -ENOENT;
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    if (record_valid(&cache.srv, now) && record_valid(&cache.a, now) && cache.port != 0) {
+        memset(out_addr, 0, sizeof(*out_addr));
+        out_addr->sin_family = AF_INET;
+        out_addr->sin_addr = cache.addr;
+        out_addr->sin_port = htons(cache.port);
+        *out_port = cache.port;
+        ret = 0;
+    }
+    k_mutex_unlock(&cache_lock);
+
+    return ret;
+}
+
+void mdns_flush_mqtt(void)
+{
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    memset(&cache.a, 0, sizeof(cache.a));
+    k_mutex_unlock(&cache_lock);
+
+    if (wake_fd >= 0) {
+        (void)zvfs_eventfd_write(wake_fd, 1);
+    }
+}
+
+int mdns_browse_mqtt(struct sockaddr_in *out_addr, uint16_t *out_port, int timeout_ms)
+{
+    int64_t deadline = k_uptime_get() + timeout_ms;
+
+    if (mdns_lookup_mqtt(out_addr, out_port) == 0) {
+        return 0;
+    }
+
+    if (wake_fd >= 0) {
+        (void)zvfs_eventfd_write(wake_fd, 1);
+    }
+    LOG_INF("mDNS: waiting up to %d ms for %s", timeout_ms, MDNS_SERVICE);
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    while (k_uptime_get() < deadline) {
+        k_condvar_wait(&cache_changed, &cache_lock, K_MSEC(deadline - k_uptime_get()));
+        k_mutex_unlock(&cache_lock);
+        if (mdns_lookup_mqtt(out_addr, out_port) == 0) {
+            return 0;
+        }
+        k_mutex_lock(&cache_lock, K_FOREVER);
+    }
+    k_mutex_unlock(&cache_lock);
 
-    close(s);
     return -ETIMEDOUT;
 }
+
+void mdns_register_broker_change_callback(mdns_broker_change_callback_t callback)
+{
+    change_callback = callback;
+}
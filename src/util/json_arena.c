@@ -0,0 +1,102 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <cJSON.h>
+#include "json_arena.h"
+
+static json_arena_t *arenas[JSON_ARENA_MAX];
+static atomic_t arena_count = ATOMIC_INIT(0);
+
+static json_arena_t *current_arena(void)
+{
+    k_tid_t self = k_current_get();
+    int count = (int)atomic_get(&arena_count);
+
+    for (int i = 0; i < count; i++) {
+        if (arenas[i]->owner == self) {
+            return arenas[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void *arena_malloc(size_t size)
+{
+    json_arena_t *arena = current_arena();
+
+    if (arena) {
+        size_t start = ROUND_UP(arena->used, JSON_ARENA_ALIGN);
+
+        if (start + size <= arena->size) {
+            arena->used = start + size;
+            arena->high_water = MAX(arena->high_water, arena->used);
+            return &arena->buf[start];
+        }
+        arena->fallbacks++;
+    }
+
+    return k_malloc(size);
+}
+
+/* Arena memory comes back with the next reset; only heap fallbacks are freed */
+static void arena_free(void *ptr)
+{
+    int count = (int)atomic_get(&arena_count);
+
+    for (int i = 0; i < count; i++) {
+        const json_arena_t *arena = arenas[i];
+        if ((uint8_t *)ptr >= arena->buf && (uint8_t *)ptr < arena->buf + arena->size) {
+            return;
+        }
+    }
+
+    k_free(ptr);
+}
+
+void json_arena_init(void)
+{
+    cJSON_Hooks hooks = {
+        .malloc_fn = arena_malloc,
+        .free_fn = arena_free,
+    };
+
+    cJSON_InitHooks(&hooks);
+}
+
+int json_arena_attach(json_arena_t *arena)
+{
+    int slot = (int)atomic_get(&arena_count);
+
+    if (slot >= JSON_ARENA_MAX) {
+        return -ENOMEM;
+    }
+
+    arena->owner = k_current_get();
+    arena->used = 0;
+    arenas[slot] = arena;
+    /* Published after the slot is filled, so the hooks never see a NULL entry */
+    atomic_inc(&arena_count);
+    return 0;
+}
+
+void json_arena_reset(json_arena_t *arena)
+{
+    arena->used = 0;
+    arena->resets++;
+}
+
+int json_arena_count(void)
+{
+    return (int)atomic_get(&arena_count);
+}
+
+int json_arena_get(int index, json_arena_t *out)
+{
+    if (index < 0 || index >= json_arena_count()) {
+        return -ENOENT;
+    }
+
+    *out = *arenas[index];
+    return 0;
+}
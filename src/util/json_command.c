@@ -0,0 +1,40 @@
+#include <errno.h>
+#include <string.h>
+#include "json_command.h"
+
+int64_t json_command_parse(const uint8_t *payload, uint32_t payload_len,
+                           char *scratch, size_t scratch_size,
+                           const struct json_obj_descr *descr, size_t descr_len,
+                           void *obj)
+{
+    if (payload_len >= scratch_size) {
+        return -EMSGSIZE;
+    }
+
+    memcpy(scratch, payload, payload_len);
+    scratch[payload_len] = '\0';
+
+    int64_t ret = json_obj_parse(scratch, payload_len, descr, descr_len, obj);
+    return ret < 0 ? -EINVAL : ret;
+}
+
+const char *json_command_missing(const struct json_obj_descr *descr, size_t descr_len,
+                                 int64_t decoded, uint32_t required)
+{
+    for (size_t i = 0; i < descr_len && i < 32; i++) {
+        if ((required & (1U << i)) && !(decoded & ((int64_t)1 << i))) {
+            return descr[i].field_name;
+        }
+    }
+
+    return NULL;
+}
+
+const char *json_command_strerror(int64_t result)
+{
+    switch (result) {
+    case -EMSGSIZE: return "Payload too large";
+    case -EINVAL:   return "Invalid JSON or field type";
+    default:        return result < 0 ? "Parse error" : "ok";
+    }
+}
@@ -0,0 +1,223 @@
+#include <errno.h>
+#include <string.h>
+#include "json_writer.h"
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static void put_char(json_writer_t *w, char c)
+{
+    /* Keep one byte for the terminator written by jw_finish() */
+    if (w->len + 1 >= w->size) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->len++] = c;
+}
+
+static void put_raw(json_writer_t *w, const char *s, size_t n)
+{
+    if (w->len + n >= w->size) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(&w->buf[w->len], s, n);
+    w->len += n;
+}
+
+/* Separator handling shared by every value and key */
+static void begin_item(json_writer_t *w)
+{
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+
+    uint32_t bit = 1U << w->depth;
+    if (w->has_items & bit) {
+        put_char(w, ',');
+    }
+    w->has_items |= bit;
+}
+
+static void put_escaped(json_writer_t *w, const char *s)
+{
+    put_char(w, '"');
+
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+
+        switch (c) {
+        case '"':  put_raw(w, "\\\"", 2); break;
+        case '\\': put_raw(w, "\\\\", 2); break;
+        case '\n': put_raw(w, "\\n", 2); break;
+        case '\r': put_raw(w, "\\r", 2); break;
+        case '\t': put_raw(w, "\\t", 2); break;
+        default:
+            if (c < 0x20) {
+                char esc[6] = {'\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xF]};
+                put_raw(w, esc, sizeof(esc));
+            } else {
+                put_char(w, (char)c);
+            }
+            break;
+        }
+    }
+
+    put_char(w, '"');
+}
+
+static void put_uint(json_writer_t *w, uint64_t value)
+{
+    char digits[20];
+    int n = 0;
+
+    /* 64-bit division is a library call on Cortex-M; most values fit in 32 bits */
+    while (value > UINT32_MAX) {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    }
+
+    uint32_t small = (uint32_t)value;
+    do {
+        digits[n++] = (char)('0' + small % 10);
+        small /= 10;
+    } while (small);
+
+    while (n--) {
+        put_char(w, digits[n]);
+    }
+}
+
+static void container_begin(json_writer_t *w, char open)
+{
+    begin_item(w);
+
+    if (w->depth + 1 >= JW_MAX_DEPTH) {
+        w->overflow = true;
+        return;
+    }
+
+    put_char(w, open);
+    w->depth++;
+    w->has_items &= ~(1U << w->depth);
+}
+
+static void container_end(json_writer_t *w, char close)
+{
+    if (w->depth == 0) {
+        w->overflow = true;
+        return;
+    }
+
+    w->depth--;
+    put_char(w, close);
+}
+
+void jw_init(json_writer_t *w, char *buf, size_t size)
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->depth = 0;
+    w->after_key = false;
+    w->overflow = (buf == NULL || size == 0);
+    w->has_items = 0;
+}
+
+int jw_finish(json_writer_t *w)
+{
+    if (w->size > 0) {
+        w->buf[w->len] = '\0';
+    }
+
+    if (w->overflow || w->depth != 0) {
+        return -ENOMEM;
+    }
+
+    return (int)w->len;
+}
+
+void jw_object_begin(json_writer_t *w)
+{
+    container_begin(w, '{');
+}
+
+void jw_object_end(json_writer_t *w)
+{
+    container_end(w, '}');
+}
+
+void jw_array_begin(json_writer_t *w)
+{
+    container_begin(w, '[');
+}
+
+void jw_array_end(json_writer_t *w)
+{
+    container_end(w, ']');
+}
+
+void jw_key(json_writer_t *w, const char *key)
+{
+    begin_item(w);
+    put_escaped(w, key);
+    put_char(w, ':');
+    w->after_key = true;
+}
+
+void jw_string(json_writer_t *w, const char *value)
+{
+    begin_item(w);
+    if (!value) {
+        put_raw(w, "null", 4);
+        return;
+    }
+    put_escaped(w, value);
+}
+
+void jw_uint(json_writer_t *w, uint64_t value)
+{
+    begin_item(w);
+    put_uint(w, value);
+}
+
+void jw_int(json_writer_t *w, int64_t value)
+{
+    begin_item(w);
+    if (value < 0) {
+        put_char(w, '-');
+        /* Negate in unsigned space so INT64_MIN does not overflow */
+        put_uint(w, (uint64_t)0 - (uint64_t)value);
+    } else {
+        put_uint(w, (uint64_t)value);
+    }
+}
+
+void jw_bool(json_writer_t *w, bool value)
+{
+    begin_item(w);
+    if (value) {
+        put_raw(w, "true", 4);
+    } else {
+        put_raw(w, "false", 5);
+    }
+}
+
+void jw_null(json_writer_t *w)
+{
+    begin_item(w);
+    put_raw(w, "null", 4);
+}
+
+void jw_hex64(json_writer_t *w, uint64_t value)
+{
+    char text[20] = {'"', '0', 'x'};
+
+    for (int i = 0; i < 16; i++) {
+        text[3 + i] = hex_digits[(value >> (60 - 4 * i)) & 0xF];
+    }
+    text[19] = '"';
+
+    begin_item(w);
+    put_raw(w, text, sizeof(text));
+}
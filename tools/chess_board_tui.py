@@ -3,6 +3,7 @@ import argparse
 import json
 import threading
 import queue
+import struct
 import sys
 import time
 
@@ -13,11 +14,56 @@ from rich.live import Live
 
 BROKER_DEFAULT = "localhost"
 TOPIC = "chess/board/fullstate"
+TOPIC_BIN = "chess/board/state/bin"
+TOPIC_DELTA = "chess/board/delta"
+TOPIC_KEYFRAME = "chess/board/keyframe"
+TOPIC_KEYFRAME_REQUEST = "chess/board/keyframe/request"
+
+# Binary board state (see include/wire_format.h): version, type, reserved, timestamp, moves, mask
+BOARD_STATE_BIN = struct.Struct("<BBHIIQ")
+WIRE_FORMAT_VERSION = 1
+WIRE_MSG_BOARD_STATE = 1
 
 class BoardState:
     def __init__(self):
         self.board = [[0]*8 for _ in range(8)]
         self.timestamp = 0
+        # Delta stream position; None until the first keyframe arrives
+        self.epoch = None
+        self.seq = None
+        self.resync_needed = False
+        self.gaps = 0
+
+    def set_mask(self, mask):
+        self.board = [[(mask >> (r * 8 + c)) & 1 for c in range(8)] for r in range(8)]
+
+    def get_mask(self):
+        return sum(self.board[r][c] << (r * 8 + c) for r in range(8) for c in range(8))
+
+    def apply_keyframe(self, data):
+        # Older keyframes of the same boot are stale; a new epoch means the board rebooted
+        if data["epoch"] == self.epoch and self.seq is not None and data["seq"] < self.seq:
+            return
+        self.epoch = data["epoch"]
+        self.seq = data["seq"]
+        self.set_mask(int(data["mask"], 16))
+        self.timestamp = data.get("t", self.timestamp)
+        self.resync_needed = False
+
+    def apply_delta(self, data):
+        if self.seq is None or data["epoch"] != self.epoch:
+            self.resync_needed = True
+            return
+        if data["seq"] <= self.seq:
+            return  # duplicate (QoS 1 redelivery)
+        if data["seq"] != self.seq + 1:
+            self.gaps += 1
+            self.seq = None
+            self.resync_needed = True
+            return
+        self.seq = data["seq"]
+        self.set_mask(self.get_mask() ^ int(data["xor"], 16))
+        self.timestamp = data.get("t", self.timestamp)
 
     def update_from_json(self, payload):
         try:
@@ -29,8 +75,35 @@ class BoardState:
         except Exception:
             pass
 
+    def update_from_bin(self, payload):
+        if len(payload) < BOARD_STATE_BIN.size:
+            return
+        version, msg_type, _, timestamp, _, mask = BOARD_STATE_BIN.unpack_from(payload)
+        if version != WIRE_FORMAT_VERSION or msg_type != WIRE_MSG_BOARD_STATE:
+            return
+        self.board = [[(mask >> (r * 8 + c)) & 1 for c in range(8)] for r in range(8)]
+        self.timestamp = timestamp
+
+    def update(self, topic, payload):
+        if topic == TOPIC_BIN:
+            self.update_from_bin(payload)
+        elif topic in (TOPIC_DELTA, TOPIC_KEYFRAME):
+            try:
+                data = json.loads(payload)
+            except ValueError:
+                return
+            if topic == TOPIC_KEYFRAME:
+                self.apply_keyframe(data)
+            else:
+                self.apply_delta(data)
+        else:
+            self.update_from_json(payload.decode(errors="replace"))
+
     def render_table(self):
-        table = Table(title=f"Chess Board (timestamp: {self.timestamp})", show_header=True, box=None, pad_edge=False)
+        title = f"Chess Board (timestamp: {self.timestamp})"
+        if self.epoch is not None:
+            title += f" seq {self.seq if self.seq is not None else '?'} gaps {self.gaps}"
+        table = Table(title=title, show_header=True, box=None, pad_edge=False)
         # Add column labels (A-H)
         col_labels = [chr(ord('A')+i) for i in range(8)]
         table.add_column("", justify="right", no_wrap=True)
@@ -52,11 +125,12 @@ class BoardState:
             table.add_row(*row_cells)
         return table
 
-def mqtt_thread(broker, state, q, stop_event):
+def mqtt_thread(broker, topics, state, q, stop_event):
     def on_connect(client, userdata, flags, rc):
-        client.subscribe(TOPIC)
+        for topic in topics:
+            client.subscribe(topic)
     def on_message(client, userdata, msg):
-        q.put(msg.payload.decode())
+        q.put((msg.topic, msg.payload))
     client = mqtt.Client()
     client.on_connect = on_connect
     client.on_message = on_message
@@ -67,7 +141,12 @@ def mqtt_thread(broker, state, q, stop_event):
         stop_event.set()
         return
     client.loop_start()
+    last_request = 0.0
     while not stop_event.is_set():
+        # Ask for a keyframe after a sequence gap, at most once per second
+        if state.resync_needed and time.monotonic() - last_request > 1.0:
+            client.publish(TOPIC_KEYFRAME_REQUEST, b"")
+            last_request = time.monotonic()
         time.sleep(0.1)
     client.loop_stop()
     client.disconnect()
@@ -75,13 +154,28 @@ def mqtt_thread(broker, state, q, stop_event):
 def main():
     parser = argparse.ArgumentParser(description="Chess Board TUI from MQTT stream")
     parser.add_argument("--broker", type=str, default=BROKER_DEFAULT, help="MQTT broker address")
+    mode = parser.add_mutually_exclusive_group()
+    mode.add_argument("--binary", action="store_true",
+                      help=f"Use {TOPIC_BIN} (CONFIG_APP_BINARY_TOPICS, only sent with each keyframe)")
+    mode.add_argument("--fullstate", action="store_true",
+                      help=f"Use {TOPIC} (only sent with each keyframe)")
+    # The default; kept so existing invocations still work
+    mode.add_argument("--delta", action="store_true",
+                      help=f"Follow {TOPIC_DELTA} from the retained keyframe, resyncing on gaps")
     args = parser.parse_args()
 
+    if args.binary:
+        topics = [TOPIC_BIN]
+    elif args.fullstate:
+        topics = [TOPIC]
+    else:
+        topics = [TOPIC_KEYFRAME, TOPIC_DELTA]
+
     state = BoardState()
     q = queue.Queue()
     stop_event = threading.Event()
 
-    t = threading.Thread(target=mqtt_thread, args=(args.broker, state, q, stop_event), daemon=True)
+    t = threading.Thread(target=mqtt_thread, args=(args.broker, topics, state, q, stop_event), daemon=True)
     t.start()
 
     console = Console()
@@ -89,8 +183,8 @@ def main():
         try:
             while not stop_event.is_set():
                 try:
-                    payload = q.get(timeout=0.5)
-                    state.update_from_json(payload)
+                    topic, payload = q.get(timeout=0.5)
+                    state.update(topic, payload)
                     live.update(state.render_table())
                 except queue.Empty:
                     pass
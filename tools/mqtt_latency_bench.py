@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Measure MQTT round-trip latency to the firmware with chess/system/ping.
+
+Each ping carries {"seq": n}; the firmware echoes seq in chess/system/pong,
+so replies are matched even when pongs arrive late or out of order.
+
+    uv run tools/mqtt_latency_bench.py --broker 192.168.1.10 --count 200
+    uv run tools/mqtt_latency_bench.py --burst --count 100   # inbound throughput
+"""
+import argparse
+import json
+import statistics
+import threading
+import time
+
+import paho.mqtt.client as mqtt
+
+BROKER_DEFAULT = "localhost"
+TOPIC_PING = "chess/system/ping"
+TOPIC_PONG = "chess/system/pong"
+
+
+class PongTracker:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.sent = {}
+        self.rtt_ms = {}
+        self.arrived = threading.Condition(self.lock)
+
+    def mark_sent(self, seq):
+        with self.lock:
+            self.sent[seq] = time.perf_counter()
+
+    def on_pong(self, payload):
+        now = time.perf_counter()
+        try:
+            seq = json.loads(payload)["seq"]
+        except (ValueError, KeyError, TypeError):
+            return
+        with self.lock:
+            start = self.sent.get(seq)
+            if start is not None and seq not in self.rtt_ms:
+                self.rtt_ms[seq] = (now - start) * 1000.0
+                self.arrived.notify_all()
+
+    def wait_for(self, seqs, timeout):
+        deadline = time.monotonic() + timeout
+        with self.lock:
+            while not all(s in self.rtt_ms for s in seqs):
+                left = deadline - time.monotonic()
+                if left <= 0:
+                    return False
+                self.arrived.wait(left)
+        return True
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Ping/pong round-trip latency benchmark")
+    parser.add_argument("--broker", type=str, default=BROKER_DEFAULT, help="MQTT broker address")
+    parser.add_argument("--port", type=int, default=1883, help="MQTT broker port")
+    parser.add_argument("--count", type=int, default=100, help="Number of pings")
+    parser.add_argument("--interval", type=float, default=0.05,
+                        help="Pause between pings in seconds (sequential mode)")
+    parser.add_argument("--timeout", type=float, default=2.0, help="Seconds to wait for each pong")
+    parser.add_argument("--qos", type=int, choices=[0, 1], default=1, help="QoS of the pings")
+    parser.add_argument("--burst", action="store_true",
+                        help="Send all pings back to back and measure how fast pongs return")
+    args = parser.parse_args()
+
+    tracker = PongTracker()
+    connected = threading.Event()
+
+    def on_connect(client, userdata, flags, reason_code, properties):
+        client.subscribe(TOPIC_PONG, qos=1)
+
+    def on_subscribe(client, userdata, mid, reason_codes, properties):
+        connected.set()
+
+    def on_message(client, userdata, msg):
+        tracker.on_pong(msg.payload)
+
+    client = mqtt.Client(mqtt.CallbackAPIVersion.VERSION2)
+    client.on_connect = on_connect
+    client.on_subscribe = on_subscribe
+    client.on_message = on_message
+    client.connect(args.broker, args.port)
+    client.loop_start()
+
+    if not connected.wait(5.0):
+        print("Could not subscribe to the pong topic")
+        client.loop_stop()
+        return 1
+
+    # Discard a pong that may still be in flight from an earlier run
+    time.sleep(0.2)
+
+    seqs = list(range(1, args.count + 1))
+    started = time.perf_counter()
+
+    if args.burst:
+        for seq in seqs:
+            tracker.mark_sent(seq)
+            client.publish(TOPIC_PING, json.dumps({"seq": seq}), qos=args.qos)
+        tracker.wait_for(seqs, args.timeout + args.count * 0.05)
+    else:
+        for seq in seqs:
+            tracker.mark_sent(seq)
+            client.publish(TOPIC_PING, json.dumps({"seq": seq}), qos=args.qos)
+            tracker.wait_for([seq], args.timeout)
+            time.sleep(args.interval)
+
+    elapsed = time.perf_counter() - started
+    client.loop_stop()
+    client.disconnect()
+
+    rtts = list(tracker.rtt_ms.values())
+    lost = args.count - len(rtts)
+    print(f"{len(rtts)}/{args.count} pongs received, {lost} lost")
+    if not rtts:
+        return 1
+
+    print(f"rtt ms  min {min(rtts):.1f}  median {statistics.median(rtts):.1f}  "
+          f"p95 {percentile(rtts, 95):.1f}  p99 {percentile(rtts, 99):.1f}  max {max(rtts):.1f}")
+    if args.burst:
+        print(f"throughput {len(rtts) / elapsed:.1f} round trips/s")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())